@@ -1,10 +1,11 @@
 #pragma once
 #include <stdbool.h>
+#include "search.h"
 
 typedef enum {
     AI_EASY = 0,    // random
-    AI_MEDIUM,      // minimax depth 2–3
-    AI_HARD         // minimax depth 4–5
+    AI_MEDIUM,      // node-limited search
+    AI_HARD         // time-limited search
 } AIDifficulty;
 
 extern AIDifficulty ai_difficulty;
@@ -12,9 +13,68 @@ extern AIDifficulty ai_difficulty;
 // Set AI difficulty
 void set_ai_difficulty(AIDifficulty diff);
 
-// AI move (returns true if a move was made)
+// Search budget for a difficulty level
+void ai_difficulty_limits(AIDifficulty diff, SearchLimits *limits);
+
+// Play from the opening book (when one is open) for the first plies of a
+// game; 0 always searches
+void ai_set_book_depth(int plies);
+
+// AI move (returns true if a move was made). search_depth caps the
+// difficulty's budget; 0 leaves it to time and nodes.
 bool ai_move(int board[8][8], int color, int search_depth, AIDifficulty diff);
 
-// Minimax interface
-float evaluate_board(int board[8][8], int color);
-float minimax(int board[8][8], int depth, float alpha, float beta, int maximizingPlayer, int color, int *out_fr, int *out_fc, int *out_tr, int *out_tc);
\ No newline at end of file
+// --- Asynchronous search, so the render loop never blocks on the AI ---
+typedef enum {
+    AI_SEARCH_IDLE,       // nothing started, or the last result was already collected
+    AI_SEARCH_RUNNING,
+    AI_SEARCH_PONDERING,  // searching the predicted reply, waiting for the opponent's move
+    AI_SEARCH_DONE,       // result ready
+    AI_SEARCH_NO_MOVE     // finished: the side to move had no legal moves
+} AISearchStatus;
+
+// Start searching private copies of pos and its game history (may be NULL) on
+// the AI worker thread. limits->stop is replaced by the worker's own flag.
+// A book move (see ai_set_book_depth) is reported on the next poll, unsearched.
+// Returns false if a search is already running or the thread could not be started.
+bool ai_start_search(const Position *pos, const KeyHistory *history, const SearchLimits *limits);
+
+// Non-blocking; call once per frame. Fills result and returns AI_SEARCH_DONE
+// once, then AI_SEARCH_IDLE until the next ai_start_search.
+AISearchStatus ai_poll_result(SearchResult *result);
+
+// --- Pondering: thinking on the opponent's time ---
+// After playing result->best_move, the AI keeps searching the position the
+// principal variation expects next. pos and history are the game after the
+// AI's move; false when there is no prediction, pondering is off, or a
+// search is already running. Polls report AI_SEARCH_PONDERING meanwhile.
+bool ai_start_ponder(const Position *pos, const KeyHistory *history, const SearchResult *last, const SearchLimits *limits);
+
+// Call whenever the opponent has moved (a local click or a move from the
+// network); pos and history are the game now, AI to move. If the ponder
+// search guessed this position it carries on, tree and all, with its time
+// budget starting now. Otherwise it is dropped and a fresh search starts.
+// Then poll as after ai_start_search.
+bool ai_opponent_moved(const Position *pos, const KeyHistory *history, const SearchLimits *limits);
+
+void ai_set_ponder(bool enabled);
+
+// Latest principal variations of the running (or last) search, best first,
+// as of its last completed iteration; returns how many were copied. Set
+// limits->multipv for several lines, e.g. for an analysis panel polling each
+// frame. limits->report, if set, is still called on the worker thread.
+int ai_search_lines(SearchLine *lines, int max);
+
+// Statistics of the running (or last) search as of its last completed
+// iteration, then its final totals; false before the first iteration
+bool ai_search_stats(SearchStats *stats);
+
+// Stop a running search and discard its result; safe to call when no search
+// is running. The search checks the stop flag every 1024 nodes but always
+// finishes its first (depth 1) iteration, so this returns once that is done:
+// usually within milliseconds, longer only for a very slow first iteration.
+void ai_cancel(void);
+
+// Minimax interface; scores in centipawns for color (see MATE_SCORE)
+int evaluate_board(int board[8][8], int color);
+int minimax(int board[8][8], int depth, int alpha, int beta, int maximizingPlayer, int color, int *out_fr, int *out_fc, int *out_tr, int *out_tc);
\ No newline at end of file
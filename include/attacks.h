@@ -0,0 +1,50 @@
+#pragma once
+#include <stdbool.h>
+#include "position.h"
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+// Sliding attacks for one square, indexed by magic multiply (or PEXT with BMI2)
+typedef struct {
+    Bitboard mask;      // relevant blockers, board edges excluded
+    Bitboard magic;
+    Bitboard *attacks;
+    int shift;
+} Magic;
+
+extern Bitboard knight_attacks[64];
+extern Bitboard king_attacks[64];
+extern Bitboard pawn_attacks[2][64];   // [COLOR_IDX(color)][sq]: squares a pawn of color on sq attacks
+extern Bitboard between_bb[64][64];   // squares strictly between two aligned squares, else 0
+extern Bitboard line_bb[64][64];      // full line through two aligned squares, else 0
+extern Magic bishop_magics[64];
+extern Magic rook_magics[64];
+
+// Build all tables; call once at startup before any move generation
+void attacks_init(void);
+
+static inline unsigned magic_index(const Magic *m, Bitboard occ) {
+#if defined(__BMI2__)
+    return (unsigned)_pext_u64(occ, m->mask);
+#else
+    return (unsigned)(((occ & m->mask) * m->magic) >> m->shift);
+#endif
+}
+
+static inline Bitboard bishop_attacks(int sq, Bitboard occ) {
+    return bishop_magics[sq].attacks[magic_index(&bishop_magics[sq], occ)];
+}
+static inline Bitboard rook_attacks(int sq, Bitboard occ) {
+    return rook_magics[sq].attacks[magic_index(&rook_magics[sq], occ)];
+}
+static inline Bitboard queen_attacks(int sq, Bitboard occ) {
+    return bishop_attacks(sq, occ) | rook_attacks(sq, occ);
+}
+
+// Pieces of both colors attacking sq when the board occupancy is occ
+Bitboard attackers_to(const Position *pos, int sq, Bitboard occ);
+
+// True if a piece of by_color attacks sq
+bool square_attacked(const Position *pos, int sq, int by_color);
@@ -0,0 +1,35 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "position.h"
+#include "movegen.h"
+
+// Opening book in the Polyglot .bin layout: 16-byte big-endian records
+// (key, move, weight, learn) sorted by key. Keys are this engine's Zobrist
+// keys, so books come from vortex-book rather than third-party Polyglot files.
+#define BOOK_ENTRY_SIZE 16
+#define BOOK_DEFAULT_DEPTH 16   // plies
+
+typedef struct {
+    uint64_t key;
+    uint16_t move;     // to file | to row << 3 | from file << 6 | from row << 9 | promo << 12
+    uint16_t weight;
+    uint32_t learn;
+} BookEntry;
+
+// Map a book file read-only; the file is searched in place, never parsed.
+// Replaces any book already open.
+bool book_open(const char *path);
+void book_close(void);
+bool book_loaded(void);
+
+// Weighted-random book move for pos; false if the position is not in the book
+bool book_probe(const Position *pos, Move *out);
+
+// Polyglot move encoding; castling is written as the king taking its own rook
+uint16_t book_encode_move(Move m);
+bool book_decode_move(const Position *pos, uint16_t move, Move *out);
+
+// Record serialization, shared with the book builder
+void book_entry_write(const BookEntry *e, uint8_t out[BOOK_ENTRY_SIZE]);
+void book_entry_read(const uint8_t in[BOOK_ENTRY_SIZE], BookEntry *e);
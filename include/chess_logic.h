@@ -1,14 +1,51 @@
 #pragma once
 #include <stdbool.h>
+#include "position.h"
+#include "rules.h"
 
 // Turn system
 typedef enum { WHITE_TURN = 1, BLACK_TURN = -1 } Turn;
 
+// Everything about a game the board alone does not record: whose turn it is,
+// which kings and rooks have moved, the pawn that just moved two squares, and
+// the history the draw rules need. Each game, search or analysis owns its
+// own, so several can run at once.
+typedef struct {
+    Turn turn;
+    bool king_moved[2];       // [COLOR_IDX(color)]
+    bool rook_moved[2][2];    // [COLOR_IDX(color)][0 = a-file rook, 1 = h-file rook]
+    int ep_row, ep_col;       // pawn that just moved two squares, -1 if none
+    int halfmove;             // plies since the last capture or pawn move
+    int ply;                  // plies played since the start of the game
+    KeyHistory history;       // earlier positions, for repetition
+} GameContext;
+
+// --- Context API ---
+void game_reset(GameContext *game);
+void game_update_move_state(GameContext *game, int fr, int fc, int tr, int tc, int movedPiece);
+
+// Bitboard snapshot of the game: board plus turn, castling and en-passant state
+void game_position(const GameContext *game, int board[8][8], Position *pos);
+
+bool game_is_valid_move(const GameContext *game, int board[8][8], int fr, int fc, int tr, int tc);
+void game_apply_move(GameContext *game, int board[8][8], int fr, int fc, int tr, int tc);
+// As game_apply_move, but a pawn reaching the last rank becomes promo
+// (piece type W_ROOK..W_QUEEN); EMPTY promotes to a queen
+void game_apply_promotion(GameContext *game, int board[8][8], int fr, int fc, int tr, int tc, int promo);
+bool game_can_castle(const GameContext *game, int board[8][8], int fr, int fc, int tr, int tc);
+bool game_can_en_passant(const GameContext *game, int board[8][8], int fr, int fc, int tr, int tc);
+bool game_has_valid_moves(const GameContext *game, int board[8][8], int color);
+
+// Result of the game so far for the side to move
+GameStatus game_status(const GameContext *game, int board[8][8]);
+
+// --- Wrappers over one process-wide game, for the existing single-game callers ---
 extern Turn current_turn;
 
 // Move logic
 bool is_valid_move(int board[8][8], int fr, int fc, int tr, int tc);
 void apply_move(int board[8][8], int fr, int fc, int tr, int tc);
+void apply_promotion(int board[8][8], int fr, int fc, int tr, int tc, int promo);
 
 // Special move helpers
 bool can_castle(int board[8][8], int fr, int fc, int tr, int tc);
@@ -19,6 +56,13 @@ void promote_pawn(int board[8][8], int row, int col);
 void reset_move_state();
 void update_move_state(int fr, int fc, int tr, int tc, int movedPiece);
 
+void current_position(int board[8][8], Position *pos);
+GameStatus current_status(int board[8][8]);
+
+// The process-wide game, for callers that search it (repetition history)
+const GameContext *current_game(void);
+
+// --- Stateless board helpers ---
 bool is_opponent_piece(int board[8][8], int fr, int fc, int tr, int tc);
 bool is_same_color(int board[8][8], int fr, int fc, int tr, int tc);
 bool is_path_clear(int board[8][8], int fr, int fc, int tr, int tc);
@@ -30,4 +74,3 @@ bool has_valid_moves(int board[8][8], int color);
 
 // New helper: validate moves without considering check
 bool is_valid_move_no_check(int board[8][8], int fr, int fc, int tr, int tc);
-
@@ -6,6 +6,11 @@ typedef struct {
     bool fullscreen;
     int ai_difficulty;
     float volume;
+    int hash_mb;        // AI transposition table size
+    int threads;        // AI search threads
+    int book_depth;     // plies the AI plays from the opening book, 0 = off
+    bool ponder;        // AI thinks on the opponent's time
+    bool nnue;          // evaluate with the network in assets/vortex.nnue when there is one
 } VortexConfig;
 
 extern VortexConfig vortex_config;
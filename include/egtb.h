@@ -0,0 +1,46 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "position.h"
+
+// Endgame tables for king and pieces against a lone king: KPK, KQK, KRK and
+// KBNK. Each stores distance to mate for every position, found by retrograde
+// analysis from the mates backwards, and answers probes exactly.
+
+typedef enum {
+    EGTB_UNKNOWN,   // material not covered, or its table is not built yet
+    EGTB_WIN,       // side to move mates
+    EGTB_DRAW,
+    EGTB_LOSS       // side to move is mated
+} EgtbResult;
+
+typedef enum { EGTB_KPK, EGTB_KQK, EGTB_KRK, EGTB_KBNK, EGTB_TABLES } EgtbTable;
+
+// Load the tables cached in dir, and build the missing ones on background
+// threads (several tables at once), saving them to dir when done. Probes
+// return EGTB_UNKNOWN for a table until it is ready. With dir NULL, or not
+// an existing directory, the tables are built in memory only.
+void egtb_init(const char *dir);
+
+// Block until every table is loaded or built
+void egtb_wait(void);
+
+// Wait for the builders, then release the tables
+void egtb_free(void);
+
+// Exact result for the side to move; *plies is the distance to mate for a
+// win or loss. Positions with castling rights are not covered.
+EgtbResult egtb_probe(const Position *pos, int *plies);
+
+// Offline statistics, counted over every legal position a table indexes
+// (mirror images included once per stored index)
+typedef struct {
+    const char *name;
+    size_t positions[2];     // legal positions, [0] strong side to move, [1] lone king to move
+    size_t wins[2];          // decided positions: strong side mates
+    int longest[2];          // longest distance to mate, in plies
+    bool ready;
+} EgtbStats;
+
+void egtb_stats(EgtbTable table, EgtbStats *stats);
@@ -0,0 +1,5 @@
+#pragma once
+
+// One-time engine setup (attack tables, Zobrist keys, piece-square tables). Call at startup,
+// before any position, move generation or search function.
+void engine_init(void);
@@ -0,0 +1,7 @@
+#pragma once
+#include "position.h"
+
+// Static evaluation from the side to move's point of view, in centipawns:
+// the NNUE network when one is loaded, the tapered piece-square sum otherwise.
+// Always well inside +-MATE_BOUND, so it never reads as a mate score.
+int evaluate(const Position *pos);
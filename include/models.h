@@ -1,22 +1,8 @@
 #pragma once
 #include "raylib.h"
+#include "pieces.h"
 #include <stdbool.h>
 
-// Piece macros
-#define EMPTY     0
-#define W_PAWN    1
-#define W_ROOK    2
-#define W_KNIGHT  3
-#define W_BISHOP  4
-#define W_QUEEN   5
-#define W_KING    6
-#define B_PAWN   -1
-#define B_ROOK   -2
-#define B_KNIGHT -3
-#define B_BISHOP -4
-#define B_QUEEN  -5
-#define B_KING   -6
-
 // Color constants
 #define WHITE 1
 #define BLACK -1
@@ -24,6 +10,8 @@
 extern Color WHITE_MAIN, WHITE_ACCENT, BLACK_MAIN, BLACK_ACCENT, BASE_RING;
 
 void draw_piece3d(int piece, int row, int col, Camera camera, float anim_scale, float anim_alpha);
+// Squares and pieces; the selected square is outlined (sel_row -1 for none)
+void draw_board3d(int board[8][8], Camera camera, int sel_row, int sel_col);
 void init_board(int board[8][8]);
 Vector3 board_to_world(int row, int col);
 
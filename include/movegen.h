@@ -0,0 +1,59 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "position.h"
+
+#define MAX_MOVES 256
+
+// Move flags
+#define MOVE_CAPTURE     1
+#define MOVE_DOUBLE_PUSH 2
+#define MOVE_EN_PASSANT  4
+#define MOVE_CASTLE      8
+
+// Move in board[8][8] coordinates
+typedef struct {
+    int8_t fr, fc, tr, tc;
+    int8_t promo;    // promotion piece type (W_ROOK..W_QUEEN), EMPTY otherwise
+    uint8_t flags;   // MOVE_* bits
+} Move;
+
+// State make_move cannot recompute, saved per ply for unmake_move
+typedef struct {
+    int8_t captured;     // piece code taken by the move, EMPTY if none
+    uint8_t castling;
+    int8_t ep_square;
+    uint8_t halfmove;
+    uint8_t phase;
+    uint64_t key;
+    Score psq;
+} Undo;
+
+#define MOVE_FROM(m) SQ((m).fr, (m).fc)
+#define MOVE_TO(m)   SQ((m).tr, (m).tc)
+
+// 16-bit form for hash tables: from | to << 6 | promo << 12; 0 means no move
+static inline uint16_t move_pack(Move m) {
+    return (uint16_t)(MOVE_FROM(m) | (MOVE_TO(m) << 6) | (m.promo << 12));
+}
+
+// Fills moves with every legal move for the side to move, returns the count
+int generate_moves(const Position *pos, Move moves[MAX_MOVES]);
+
+// Legal captures (en passant included) and promotions only, for quiescence search
+int generate_captures(const Position *pos, Move moves[MAX_MOVES]);
+
+// Early-exit probe: true as soon as one legal move is found (mate/stalemate detection)
+bool has_legal_moves(const Position *pos);
+
+// Long algebraic (UCI) notation: "e2e4", "e7e8q"; buf needs 6 bytes
+void move_to_uci(Move m, char *buf);
+
+// Play a legal move in place, recording what unmake_move needs in undo
+void make_move(Position *pos, Move m, Undo *undo);
+void unmake_move(Position *pos, Move m, const Undo *undo);
+
+// Pass the turn (null-move pruning only; never legal in a game). Clears the
+// en-passant square and the halfmove clock, so repetition checks stop here.
+void make_null_move(Position *pos, Undo *undo);
+void unmake_null_move(Position *pos, const Undo *undo);
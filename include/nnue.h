@@ -0,0 +1,74 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "position.h"
+#include "movegen.h"
+
+// Efficiently updatable neural network evaluation. The input layer is
+// HalfKP-like: for each side, one feature per (own king square, non-king
+// piece, square), seen from that side with Black's squares mirrored. Its
+// output, the accumulator, changes by a few weight rows per move, so the
+// search updates it incrementally instead of recomputing it.
+//
+// Network: features -> 2 x NNUE_L1 (int16, one half per side, side to move
+// first) -> clipped ReLU -> NNUE_L2 -> NNUE_L3 -> 1 (int8 weights, int32
+// biases), plus a direct per-feature material term (PSQT) added to the output.
+
+#define NNUE_FEATURES  (64 * 10 * 64)   // king square x (5 piece types x 2 colors) x square
+#define NNUE_L1        256
+#define NNUE_L2        32
+#define NNUE_L3        32
+
+// Hidden layer outputs are shifted down by this many bits before clipping,
+// and the final sum is divided by NNUE_OUTPUT_SCALE to give centipawns
+#define NNUE_WEIGHT_SHIFT  6
+#define NNUE_OUTPUT_SCALE  16
+
+// File layout, little-endian, memory-mapped as is:
+//   header   NNUE_HEADER_SIZE bytes: NNUE_MAGIC, then uint32 features, l1, l2, l3; zero padded
+//   int16  ft_bias[L1]         int16  ft_weights[FEATURES][L1]   int32 ft_psqt[FEATURES]
+//   int32  l1_bias[L2]         int8   l1_weights[L2][2 * L1]
+//   int32  l2_bias[L3]         int8   l2_weights[L3][L2]
+//   int32  out_bias            int8   out_weights[L3]
+#define NNUE_MAGIC        "VMNNUE01"
+#define NNUE_HEADER_SIZE  64
+
+#define NNUE_DEFAULT_PATH "assets/vortex.nnue"
+
+// Feature index of a non-king piece (signed piece code) seen from perspective
+// (1 White, -1 Black) with that side's king on king_sq
+static inline int nnue_feature(int perspective, int king_sq, int piece, int sq) {
+    int flip = perspective > 0 ? 0 : 56;
+    int theirs = (piece > 0) != (perspective > 0) ? 5 : 0;
+    int type = piece > 0 ? piece : -piece;
+    return (((king_sq ^ flip) * 10 + theirs + type - 1) << 6) + (sq ^ flip);
+}
+
+// Map a network file. Returns false, keeping the previous network (or the
+// classical evaluation if none), when the file is missing or malformed.
+// Not while a search is running.
+bool nnue_load(const char *path);
+void nnue_unload(void);
+bool nnue_loaded(void);
+
+// Evaluation from the side to move's point of view, in centipawns. Uses the
+// calling thread's incremental accumulators when pos is the position
+// attached to it, and computes them from scratch otherwise.
+int nnue_evaluate(const Position *pos);
+
+// Track pos on the calling thread: from now on make_move/unmake_move (and the
+// null move) on it keep the thread's accumulator stack in step. One position
+// per thread; detach before pos goes out of scope. No-op with no network.
+void nnue_attach(const Position *pos);
+void nnue_detach(void);
+
+// SIMD kernels: "avx2", "sse4.1" or "scalar". The best one the CPU supports is
+// chosen on load; nnue_set_kernel switches (false if unsupported or unknown).
+const char *nnue_kernel(void);
+bool nnue_set_kernel(const char *name);
+
+// Hooks called by make_move and friends for the attached position
+extern __thread const Position *nnue_tracked;
+void nnue_push_move(const Position *pos, Move m, int moved_type, int captured);
+void nnue_push_null(void);
+void nnue_pop(void);
@@ -0,0 +1,20 @@
+#pragma once
+#include <stdbool.h>
+#include "position.h"
+#include "movegen.h"
+
+// Text <-> Move for the position the move is played from. Parsers only
+// accept legal moves and fill out with the generator's move (flags included).
+
+// Long algebraic: "e2e4", "e7e8q"
+bool move_from_uci(const Position *pos, const char *str, Move *out);
+
+// Standard algebraic: "Nf3", "exd5", "O-O", "e8=Q+"; check and annotation
+// suffixes are ignored
+bool move_from_san(const Position *pos, const char *str, Move *out);
+
+// Either of the above, as found in stored games
+bool move_parse(const Position *pos, const char *str, Move *out);
+
+// Standard algebraic with check/mate suffix; buf needs 8 bytes
+void move_to_san(const Position *pos, Move m, char *buf);
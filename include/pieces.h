@@ -0,0 +1,17 @@
+#pragma once
+
+// Piece codes shared by board[8][8], the bitboard Position and the renderer.
+// White pieces are positive, Black pieces negative; abs(piece) is the type.
+#define EMPTY     0
+#define W_PAWN    1
+#define W_ROOK    2
+#define W_KNIGHT  3
+#define W_BISHOP  4
+#define W_QUEEN   5
+#define W_KING    6
+#define B_PAWN   -1
+#define B_ROOK   -2
+#define B_KNIGHT -3
+#define B_BISHOP -4
+#define B_QUEEN  -5
+#define B_KING   -6
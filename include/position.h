@@ -0,0 +1,89 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "pieces.h"
+#include "psqt.h"
+
+// 64-bit square set. Bit 0 is a1, bit 7 is h1, bit 63 is h8.
+typedef uint64_t Bitboard;
+
+// Square index <-> board[row][col] (row 0 is Black's back rank, as in init_board)
+#define SQ(row, col)   ((7 - (row)) * 8 + (col))
+#define SQ_ROW(sq)     (7 - ((sq) >> 3))
+#define SQ_COL(sq)     ((sq) & 7)
+#define SQ_NONE        (-1)
+#define SQ_BB(sq)      (1ULL << (sq))
+
+// Array index for a color: 0 = White (1), 1 = Black (-1)
+#define COLOR_IDX(color) ((color) < 0)
+
+// Castling rights bits
+#define CASTLE_WK  1
+#define CASTLE_WQ  2
+#define CASTLE_BK  4
+#define CASTLE_BQ  8
+#define CASTLE_ALL 15
+
+// Compact board: 96 bytes, so a position copy touches at most two cache lines.
+typedef struct {
+    Bitboard by_type[7];   // [W_PAWN..W_KING] per piece type, [EMPTY] = all occupied squares
+    Bitboard by_color[2];  // [COLOR_IDX(color)]
+    int8_t king_sq[2];     // [COLOR_IDX(color)], SQ_NONE if the king is missing
+    int8_t side;           // side to move: 1 (white) or -1 (black)
+    uint8_t castling;      // CASTLE_* bits
+    int8_t ep_square;      // square a pawn can capture onto en passant, or SQ_NONE
+    uint8_t halfmove;      // plies since the last capture or pawn move
+    uint16_t fullmove;
+    uint64_t key;          // Zobrist key, kept up to date by make_move
+    Score psq;             // material + piece-square sum (psqt), kept up to date like key
+    uint8_t phase;         // sum of phase_weight over the pieces on the board
+} Position;
+
+// Zobrist keys; the pseudo-random stream is fixed, so keys are identical on every run
+extern uint64_t zobrist_piece[2][7][64];   // [COLOR_IDX(color)][type][sq]
+extern uint64_t zobrist_castling[16];      // [CASTLE_* bits]
+extern uint64_t zobrist_ep[8];             // [file of the en-passant square]
+extern uint64_t zobrist_side;              // toggled when Black is to move
+
+void zobrist_init(void);
+uint64_t position_compute_key(const Position *pos);
+
+// From-scratch psq, to check the incremental one
+Score position_compute_psq(const Position *pos);
+
+// --- Bit helpers ---
+static inline int bb_count(Bitboard b) { return __builtin_popcountll(b); }
+static inline int bb_lsb(Bitboard b) { return __builtin_ctzll(b); }
+static inline int bb_pop_lsb(Bitboard *b) { int sq = __builtin_ctzll(*b); *b &= *b - 1; return sq; }
+
+// --- Piece placement ---
+static inline Bitboard pos_pieces(const Position *pos, int color, int type) {
+    return pos->by_type[type] & pos->by_color[COLOR_IDX(color)];
+}
+
+// Piece code on a square (same encoding as board[8][8])
+static inline int pos_piece_on(const Position *pos, int sq) {
+    Bitboard b = SQ_BB(sq);
+    if (!(pos->by_type[EMPTY] & b)) return EMPTY;
+    int sign = (pos->by_color[0] & b) ? 1 : -1;
+    for (int type = W_PAWN; type < W_KING; type++)
+        if (pos->by_type[type] & b) return sign * type;
+    return sign * W_KING;
+}
+
+void position_clear(Position *pos);
+void position_put_piece(Position *pos, int piece, int sq);
+void position_remove_piece(Position *pos, int sq);
+
+#define START_FEN "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+
+// Parse Forsyth-Edwards Notation; returns false (pos undefined) if malformed
+// or illegal: not exactly one king a side, a pawn on the first or last rank,
+// or the side not to move in check. Needs the attack tables (engine_init).
+bool position_from_fen(Position *pos, const char *fen);
+
+// --- Adapters to the int board[8][8] used by the UI, saves and renderer ---
+// side: color to move; castling: CASTLE_* bits; ep_square: SQ_NONE if none.
+// Castling rights whose king or rook is not on its home square are dropped.
+void position_from_board(Position *pos, int board[8][8], int side, int castling, int ep_square);
+void position_to_board(const Position *pos, int board[8][8]);
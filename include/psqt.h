@@ -0,0 +1,21 @@
+#pragma once
+#include <stdint.h>
+#include "pieces.h"
+
+// Middlegame and endgame values packed in one int, so a single add or
+// subtract updates both halves: eg in the high 16 bits, mg in the low 16.
+typedef int32_t Score;
+
+#define PSQ_SCORE(mg, eg)  ((Score)((uint32_t)(eg) << 16) + (Score)(mg))
+#define SCORE_MG(s)        ((int16_t)(uint16_t)(uint32_t)(s))
+#define SCORE_EG(s)        ((int16_t)(uint16_t)((uint32_t)((s) + 0x8000) >> 16))
+
+// Game phase: 24 with all minor and major pieces on the board, 0 with none
+#define PHASE_MAX 24
+extern const int phase_weight[7];   // per piece type
+
+// Material plus piece-square value of a piece, White positive and Black negative.
+// [COLOR_IDX(color)][type][sq]
+extern Score psqt[2][7][64];
+
+void psqt_init(void);
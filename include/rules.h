@@ -0,0 +1,39 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "position.h"
+
+typedef enum {
+    GAME_ONGOING,
+    GAME_CHECKMATE,              // side to move is mated
+    GAME_STALEMATE,
+    GAME_THREEFOLD,
+    GAME_FIFTY_MOVE,
+    GAME_INSUFFICIENT_MATERIAL
+} GameStatus;
+
+#define MAX_GAME_PLIES 1024
+
+// Zobrist keys of the positions before the current one, oldest first. Only
+// plies since the last capture or pawn move matter, so keys_push drops the
+// rest when a move resets the halfmove clock.
+typedef struct {
+    uint64_t keys[MAX_GAME_PLIES];
+    int count;
+} KeyHistory;
+
+void keys_clear(KeyHistory *history);
+// Record key as the position a move was just played from; halfmove is the clock after the move
+void keys_push(KeyHistory *history, uint64_t key, int halfmove);
+
+// Earlier occurrences of pos among the last pos->halfmove plies of history
+int repetition_count(const Position *pos, const KeyHistory *history);
+
+// No sequence of legal moves can mate: bare kings, one minor piece, or
+// bishops all on squares of one color
+bool insufficient_material(const Position *pos);
+
+// Mate and stalemate come first, so a mate on the fiftieth move still counts
+GameStatus position_status(const Position *pos, const KeyHistory *history);
+
+const char *game_status_name(GameStatus status);
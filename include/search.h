@@ -0,0 +1,120 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "position.h"
+#include "movegen.h"
+#include "rules.h"
+#include "tt.h"
+
+#define MAX_PLY 64
+
+// Scores are centipawns. Mate scores sit far above any material count:
+// being mated at ply n scores -(MATE_SCORE - n), mating scores the reverse.
+#define VALUE_INF  32000
+#define MATE_SCORE 31000
+#define MAX_MATE_PLIES 512                    // search depth plus endgame table distance
+#define MATE_BOUND (MATE_SCORE - MAX_MATE_PLIES)   // |score| >= MATE_BOUND means mate
+
+static inline bool score_is_mate(int score) {
+    return score >= MATE_BOUND || score <= -MATE_BOUND;
+}
+
+// Moves (not plies) to mate, positive when the side to move mates; 0 if not a mate score
+static inline int score_mate_moves(int score) {
+    if (score >= MATE_BOUND) return (MATE_SCORE - score + 1) / 2;
+    if (score <= -MATE_BOUND) return -(MATE_SCORE + score) / 2;
+    return 0;
+}
+
+#define MAX_SEARCH_THREADS 256
+
+// Search techniques, on by default; SearchLimits.disable turns them off one
+// at a time, to measure what each saves on the same positions
+#define SEARCH_NO_PVS        1   // principal variation search: zero-window probes after the first move
+#define SEARCH_NO_ASPIRATION 2   // root window around the previous iteration's score
+#define SEARCH_NO_NULL_MOVE  4   // null-move pruning
+#define SEARCH_NO_LMR        8   // late-move reductions
+#define SEARCH_NO_CHECK_EXT  16  // one extra ply for moves that give check
+
+#define MAX_MULTIPV 16
+
+// One principal variation, as reported after each completed iteration
+typedef struct {
+    int multipv;            // rank, 1 for the best line
+    int depth;
+    int score;              // side to move's point of view, in centipawns
+    uint64_t nodes;         // all threads, since the search started
+    int time_ms;
+    int pv_length;
+    Move pv[MAX_PLY];       // pv[0] is the root move
+} SearchLine;
+
+// Called on the searching thread after every completed iteration, with the
+// lines best first; the array is only valid during the call
+typedef void (*SearchReport)(const SearchLine *lines, int count, void *ctx);
+
+// What bounds a search. Zero fields mean "no limit"; with all of them zero
+// the search runs to MAX_PLY. Time and node budgets are polled every
+// 1024 nodes, the stop flag too.
+typedef struct {
+    int depth;              // deepest iteration
+    int movetime_ms;        // wall-clock budget
+    uint64_t nodes;         // node budget
+    volatile bool *stop;    // set from another thread to end the search early
+    volatile bool *ponder;  // while set, time and nodes are not counted (opponent's time); clearing it starts both
+    unsigned disable;       // SEARCH_NO_* bits
+    int multipv;            // lines to search and report, each excluding the moves of those above (0 = 1)
+    SearchReport report;    // may be NULL
+    void *report_ctx;
+    bool keep_table_age;    // leave the table's generation alone; for callers running several searches
+                            // at once, which call tt_new_search themselves (e.g. once per finished game)
+    TTable *table;          // NULL: the process-wide table (tt_*)
+} SearchLimits;
+
+// What a search did, for tuning and display. Each thread counts into its
+// own copy; the totals are only summed when read.
+typedef struct {
+    uint64_t nodes;             // quiescence nodes included
+    uint64_t qnodes;
+    uint64_t nps;
+    int depth;                  // last completed iteration
+    int seldepth;               // deepest ply any thread reached, quiescence included
+    int time_ms;
+    uint64_t tt_probes;
+    uint64_t tt_hits;
+    uint64_t tt_cutoffs;        // hits deep enough, with a fitting bound, to end the node
+    uint64_t fail_highs;        // beta cutoffs below the root
+    uint64_t first_move_fail_highs;   // of those, on the first move tried: a measure of move ordering
+    uint64_t null_tries;
+    uint64_t null_cutoffs;
+    uint64_t lmr_researches;    // reduced moves that beat alpha and were searched again at full depth
+    uint64_t pvs_researches;    // zero-window probes that needed the full window
+    int iteration_ms[MAX_PLY];  // main thread's time for each completed iteration; [0] is depth 1
+} SearchStats;
+
+typedef struct {
+    Move best_move;         // from the last completed iteration
+    int score;              // side to move's point of view, in centipawns
+    int depth;              // last completed iteration
+    uint64_t nodes;
+    int time_ms;            // since the search started, or since pondering ended
+    Move ponder_move;       // expected reply to best_move, from the principal variation
+    bool has_ponder;
+    SearchStats stats;
+} SearchResult;
+
+// Threads used by each search (Lazy SMP), clamped to 1..MAX_SEARCH_THREADS
+void search_set_threads(int threads);
+int search_get_threads(void);
+
+// Iterative-deepening search. The first iteration always completes, so a
+// legal best move is returned however tight the limits are. Returns false
+// (result untouched) if the side to move has no legal moves.
+// history holds the game's earlier positions (may be NULL); any repetition
+// of them or within the search tree scores as a draw, as do the fifty-move
+// rule and insufficient material.
+bool search(const Position *pos, const KeyHistory *history, const SearchLimits *limits, SearchResult *result);
+
+// Only from inside a SearchReport callback: the calling search's statistics
+// so far, summed over its threads. Elsewhere out is zeroed.
+void search_current_stats(SearchStats *out);
@@ -0,0 +1,9 @@
+#pragma once
+#include "position.h"
+#include "movegen.h"
+
+// Static exchange evaluation: material the side to move gains from m
+// (in centipawns) if both sides keep recapturing on the target square
+// with their least valuable attacker, each free to stop when behind.
+// X-ray attackers behind sliders are included; pins are ignored.
+int see(const Position *pos, Move m);
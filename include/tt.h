@@ -0,0 +1,54 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum { TT_NONE = 0, TT_UPPER = 1, TT_LOWER = 2, TT_EXACT = 3 } TTBound;
+
+// Decoded entry as returned by tt_probe. In the table each entry is two
+// 64-bit words, key ^ data and data, so a probe racing a store on another
+// search thread sees a key mismatch rather than a torn entry.
+typedef struct {
+    uint64_t key;
+    int16_t score;      // side to move's point of view; mate scores relative to this node
+    uint16_t move;      // move_pack() form, 0 if none
+    int8_t depth;
+    uint8_t bound_gen;  // TTBound in the low 2 bits, search generation above
+} TTEntry;
+
+#define TT_DEFAULT_MB 16
+
+typedef struct TTBucket TTBucket;
+
+// One table. The tt_* functions below work on the process-wide one; callers
+// that need separate tables (e.g. two engines playing each other) own their
+// own and pass it to the search in SearchLimits.table. Zero-initialized is
+// an empty table that probes miss and stores skip.
+typedef struct {
+    TTBucket *buckets;
+    size_t mask;            // bucket count - 1 (power of two)
+    uint8_t generation;     // atomic access only
+} TTable;
+
+// (Re)allocate the table; contents are cleared. Returns false if allocation failed.
+bool ttable_resize(TTable *tt, size_t mb);
+void ttable_free(TTable *tt);
+void ttable_clear(TTable *tt);
+
+// Age existing entries so the replacement scheme prefers overwriting them.
+// Call from one thread at a time; searches already running store with the
+// new generation from then on.
+void ttable_new_search(TTable *tt);
+
+// Probe and store are safe to call concurrently from search threads
+bool ttable_probe(const TTable *tt, uint64_t key, TTEntry *out);
+void ttable_store(TTable *tt, uint64_t key, int depth, TTBound bound, int score, uint16_t move);
+
+// --- The process-wide table ---
+TTable *tt_global(void);
+bool tt_resize(size_t mb);
+void tt_free(void);
+void tt_clear(void);
+void tt_new_search(void);
+bool tt_probe(uint64_t key, TTEntry *out);
+void tt_store(uint64_t key, int depth, TTBound bound, int score, uint16_t move);
@@ -1,6 +1,7 @@
 #pragma once
 #include "raylib.h"
 #include "db.h"
+#include "search.h"
 
 typedef struct {
     int game_state;
@@ -9,6 +10,8 @@ typedef struct {
     char message[64];
     float eval_score;
     int show_eval;
+    SearchStats search_stats; // e.g. from ai_search_stats
+    int show_stats;           // draw the search statistics panel
     char game_result[64]; // New: for game over overlay
     float logo_alpha;     // For fade-in
 } UIOverlayInfo;
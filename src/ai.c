@@ -1,11 +1,16 @@
 #include "ai.h"
 #include "chess_logic.h"
+#include "movegen.h"
+#include "attacks.h"
+#include "search.h"
+#include "eval.h"
+#include "book.h"
 #include "models.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
 #include <string.h>
-#include <float.h>
+#include <pthread.h>
 
 AIDifficulty ai_difficulty = AI_MEDIUM;
 
@@ -13,127 +18,81 @@ void set_ai_difficulty(AIDifficulty diff) {
     ai_difficulty = diff;
 }
 
-// Piece values for evaluation
-static const float piece_value[7] = {0, 1.0f, 5.0f, 3.0f, 3.0f, 9.0f, 100.0f};
+// Search budgets per difficulty. Medium is bounded by nodes so its strength
+// does not depend on the machine; Hard thinks for a fixed time.
+static const SearchLimits difficulty_limits[] = {
+    [AI_EASY]   = {.depth = 1},
+    [AI_MEDIUM] = {.movetime_ms = 500, .nodes = 20000},
+    [AI_HARD]   = {.movetime_ms = 1500},
+};
 
-// Move struct
-typedef struct {
-    int fr, fc, tr, tc;
-} Move;
+void ai_difficulty_limits(AIDifficulty diff, SearchLimits *limits) {
+    *limits = difficulty_limits[diff];
+}
 
-#define MAX_MOVES 256
+static int book_depth = BOOK_DEFAULT_DEPTH;
 
-// Generate all valid moves for a color
-static int generate_all_valid_moves(int board[8][8], int color, Move moves[MAX_MOVES]) {
-    int count = 0;
-    for (int fr = 0; fr < 8; fr++) {
-        for (int fc = 0; fc < 8; fc++) {
-            int piece = board[fr][fc];
-            if (piece == EMPTY || ((piece > 0) != (color > 0))) continue;
-            for (int tr = 0; tr < 8; tr++) {
-                for (int tc = 0; tc < 8; tc++) {
-                    if (is_valid_move(board, fr, fc, tr, tc)) {
-                        if (count < MAX_MOVES) {
-                            moves[count++] = (Move){fr, fc, tr, tc};
-                        }
-                    }
-                }
-            }
-        }
-    }
-    return count;
+void ai_set_book_depth(int plies) {
+    book_depth = plies < 0 ? 0 : plies;
 }
 
-// Simple board evaluation
-float evaluate_board(int board[8][8], int color) {
-    float score = 0.0f;
-    for (int r = 0; r < 8; r++) {
-        for (int c = 0; c < 8; c++) {
-            int piece = board[r][c];
-            if (piece == EMPTY) continue;
-            int abs_piece = (piece > 0) ? piece : -piece;
-            float val = piece_value[abs_piece];
-            if (piece > 0) score += val;
-            else score -= val;
-        }
+// Book move while the game is still within book_depth plies of the start
+static bool book_move(const Position *pos, Move *out) {
+    int ply = (pos->fullmove - 1) * 2 + (pos->side < 0);
+    return ply < book_depth && book_probe(pos, out);
+}
+
+// Game position with `color` to move; an en-passant right belongs only to the side whose turn it is.
+// Returns the game's repetition history, or NULL when color is not actually to move.
+static const KeyHistory *board_position(int board[8][8], int color, Position *pos) {
+    current_position(board, pos);
+    if (pos->side != color) {
+        pos->side = (int8_t)color;
+        pos->ep_square = SQ_NONE;
+        pos->key = position_compute_key(pos);
+        return NULL;
     }
-    return score * color;
+    return &current_game()->history;
 }
 
-// Minimax with alpha-beta pruning
-float minimax(int board[8][8], int depth, float alpha, float beta, int maximizingPlayer, int color, int *out_fr, int *out_fc, int *out_tr, int *out_tc) {
-    int current_color = maximizingPlayer ? color : -color;
+// Generate all valid moves for a color
+static int generate_all_valid_moves(int board[8][8], int color, Move moves[MAX_MOVES]) {
+    Position pos;
+    board_position(board, color, &pos);
+    return generate_moves(&pos, moves);
+}
 
-    if (depth == 0 || !has_valid_moves(board, current_color)) {
-        float eval = evaluate_board(board, color);
-        bool in_check = is_in_check(board, current_color);
-        if (!has_valid_moves(board, current_color)) {
-            if (in_check)
-                eval = (current_color == color) ? -999.0f : 999.0f;
-            else
-                eval = 0.0f; // stalemate
-        }
-        return eval;
-    }
+// Static evaluation in centipawns for color
+int evaluate_board(int board[8][8], int color) {
+    Position pos;
+    position_from_board(&pos, board, color, 0, SQ_NONE);
+    return evaluate(&pos);
+}
 
-    Move moves[MAX_MOVES];
-    int move_count = generate_all_valid_moves(board, current_color, moves);
-
-    if (move_count == 0)
-        return evaluate_board(board, color);
-
-    int best_indices[MAX_MOVES];
-    int best_count = 0;
-    float best_eval = maximizingPlayer ? -FLT_MAX : FLT_MAX;
-
-    for (int i = 0; i < move_count; i++) {
-        int tmp_board[8][8];
-        memcpy(tmp_board, board, sizeof(tmp_board));
-        int fr = moves[i].fr, fc = moves[i].fc, tr = moves[i].tr, tc = moves[i].tc;
-        
-        // Make the move
-        int moved_piece = tmp_board[fr][fc];
-        tmp_board[tr][tc] = moved_piece;
-        tmp_board[fr][fc] = EMPTY;
-        
-        // Pawn promotion
-        if ((moved_piece == W_PAWN && tr == 0) || (moved_piece == B_PAWN && tr == 7))
-            tmp_board[tr][tc] = (moved_piece > 0) ? W_QUEEN : B_QUEEN;
-
-        float eval = minimax(tmp_board, depth-1, alpha, beta, !maximizingPlayer, color, NULL, NULL, NULL, NULL);
-
-        if (maximizingPlayer) {
-            if (eval > best_eval) {
-                best_eval = eval;
-                best_indices[0] = i; 
-                best_count = 1;
-            } else if (eval == best_eval) {
-                best_indices[best_count++] = i;
-            }
-            if (eval > alpha) alpha = eval;
-        } else {
-            if (eval < best_eval) {
-                best_eval = eval;
-                best_indices[0] = i; 
-                best_count = 1;
-            } else if (eval == best_eval) {
-                best_indices[best_count++] = i;
-            }
-            if (eval < beta) beta = eval;
-        }
-        if (beta <= alpha) break;
-    }
+// Fixed-depth search, kept for existing callers. The search runs on a full
+// window, so alpha and beta are ignored.
+int minimax(int board[8][8], int depth, int alpha, int beta, int maximizingPlayer, int color, int *out_fr, int *out_fc, int *out_tr, int *out_tc) {
+    (void)alpha;
+    (void)beta;
+    Position pos;
+    const KeyHistory *history = board_position(board, maximizingPlayer ? color : -color, &pos);
 
-    // Output best move at root
-    if (out_fr && best_count > 0) {
-        int idx = best_indices[rand() % best_count];
-        *out_fr = moves[idx].fr;
-        *out_fc = moves[idx].fc;
-        *out_tr = moves[idx].tr;
-        *out_tc = moves[idx].tc;
+    SearchLimits limits = {.depth = depth > 0 ? depth : 1};
+    SearchResult result;
+    if (!search(&pos, history, &limits, &result)) {
+        // No legal moves: mated or stalemate, scored for the side to move
+        if (out_fr) *out_fr = *out_fc = *out_tr = *out_tc = -1;
+        int eval = square_attacked(&pos, pos.king_sq[COLOR_IDX(pos.side)], -pos.side) ? -MATE_SCORE : 0;
+        return maximizingPlayer ? eval : -eval;
     }
 
-    return best_eval;
+    if (out_fr) {
+        *out_fr = result.best_move.fr;
+        *out_fc = result.best_move.fc;
+        *out_tr = result.best_move.tr;
+        *out_tc = result.best_move.tc;
+    }
+    return maximizingPlayer ? result.score : -result.score;
 }
 
 // AI move implementation
@@ -142,7 +101,7 @@ bool ai_move(int board[8][8], int color, int search_depth, AIDifficulty diff) {
     int count = generate_all_valid_moves(board, color, moves);
     if (count == 0) return false;
     
-    int fr = -1, fc = -1, tr = -1, tc = -1;
+    int fr = -1, fc = -1, tr = -1, tc = -1, promo = EMPTY;
     
     if (diff == AI_EASY) {
         srand((unsigned int)time(NULL) ^ rand());
@@ -151,19 +110,208 @@ bool ai_move(int board[8][8], int color, int search_depth, AIDifficulty diff) {
         fc = moves[idx].fc; 
         tr = moves[idx].tr; 
         tc = moves[idx].tc;
+        promo = moves[idx].promo;
     } else {
-        int depth = (diff == AI_MEDIUM) ? (search_depth < 2 ? 2 : search_depth) : (search_depth < 4 ? 4 : search_depth);
-        minimax(board, depth, -FLT_MAX, FLT_MAX, 1, color, &fr, &fc, &tr, &tc);
-        if (fr == -1) { // fallback if minimax fails
-            int idx = rand() % count;
-            fr = moves[idx].fr; 
-            fc = moves[idx].fc; 
-            tr = moves[idx].tr; 
-            tc = moves[idx].tc;
+        Position pos;
+        const KeyHistory *history = board_position(board, color, &pos);
+        Move m;
+        if (history && book_move(&pos, &m)) {
+            apply_promotion(board, m.fr, m.fc, m.tr, m.tc, m.promo);
+            return true;
+        }
+        SearchLimits limits;
+        ai_difficulty_limits(diff, &limits);
+        if (search_depth > 0 && (limits.depth == 0 || search_depth < limits.depth)) limits.depth = search_depth;
+        SearchResult result;
+        if (search(&pos, history, &limits, &result)) {
+            fr = result.best_move.fr;
+            fc = result.best_move.fc;
+            tr = result.best_move.tr;
+            tc = result.best_move.tc;
+            promo = result.best_move.promo;
         }
     }
     
     if (fr == -1) return false;
-    apply_move(board, fr, fc, tr, tc);
+    apply_promotion(board, fr, fc, tr, tc, promo);
     return true;
-}
\ No newline at end of file
+}
+
+// --- Asynchronous search ---
+// One search at a time on its own thread. The worker owns copies of the
+// position and limits; the main thread only touches the status under the lock.
+static pthread_t search_thread;
+static pthread_mutex_t search_lock = PTHREAD_MUTEX_INITIALIZER;
+static AISearchStatus search_status = AI_SEARCH_IDLE;
+static bool search_finished = false;  // worker done, thread not yet joined
+static bool search_threaded = false;  // false when the book answered without a thread
+static volatile bool search_stop = false;
+static volatile bool search_ponder = false;   // searching on the opponent's time
+static uint64_t ponder_key;                   // position the ponder search assumed
+static bool ponder_enabled = true;
+static Position search_pos;
+static KeyHistory search_history;
+static bool search_has_history = false;
+static SearchLimits search_limits;
+static SearchResult search_result;
+static bool search_found = false;
+static SearchLine search_lines[MAX_MULTIPV];   // latest report, under the lock
+static int search_line_count = 0;
+static SearchStats search_stats;               // as of the latest report, then the final totals
+static bool search_has_stats = false;
+static SearchReport caller_report = NULL;
+static void *caller_report_ctx = NULL;
+
+// Keep the latest lines for ai_search_lines, then pass them on
+static void store_lines(const SearchLine *lines, int count, void *ctx) {
+    (void)ctx;
+    pthread_mutex_lock(&search_lock);
+    memcpy(search_lines, lines, (size_t)count * sizeof(SearchLine));
+    search_line_count = count;
+    search_current_stats(&search_stats);
+    search_has_stats = true;
+    pthread_mutex_unlock(&search_lock);
+    if (caller_report) caller_report(lines, count, caller_report_ctx);
+}
+
+static void *search_thread_main(void *arg) {
+    (void)arg;
+    SearchResult result;
+    bool found = search(&search_pos, search_has_history ? &search_history : NULL, &search_limits, &result);
+    pthread_mutex_lock(&search_lock);
+    search_result = result;
+    search_found = found;
+    if (found) {
+        search_stats = result.stats;
+        search_has_stats = true;
+    }
+    search_finished = true;
+    pthread_mutex_unlock(&search_lock);
+    return NULL;
+}
+
+static void copy_search_input(const Position *pos, const KeyHistory *history, const SearchLimits *limits) {
+    search_pos = *pos;
+    search_has_history = (history != NULL);
+    if (history) search_history = *history;
+    search_limits = *limits;
+    search_limits.stop = &search_stop;
+    search_limits.ponder = &search_ponder;
+    search_limits.report = store_lines;
+    caller_report = limits->report;
+    caller_report_ctx = limits->report_ctx;
+    search_stop = false;
+    pthread_mutex_lock(&search_lock);
+    search_line_count = 0;
+    search_has_stats = false;
+    pthread_mutex_unlock(&search_lock);
+}
+
+static bool launch_search_thread(void) {
+    search_finished = false;
+    if (pthread_create(&search_thread, NULL, search_thread_main, NULL) != 0) {
+        fprintf(stderr, "Warning: could not start the AI search thread.\n");
+        return false;
+    }
+    search_threaded = true;
+    search_status = AI_SEARCH_RUNNING;
+    return true;
+}
+
+bool ai_start_search(const Position *pos, const KeyHistory *history, const SearchLimits *limits) {
+    if (search_status == AI_SEARCH_RUNNING) return false;
+    copy_search_input(pos, history, limits);
+    search_ponder = false;
+
+    // Book moves need no search: report them on the next poll
+    Move m;
+    if (book_move(pos, &m)) {
+        memset(&search_result, 0, sizeof(search_result));
+        search_result.best_move = m;
+        search_found = true;
+        search_finished = true;
+        search_threaded = false;
+        search_status = AI_SEARCH_RUNNING;
+        return true;
+    }
+    return launch_search_thread();
+}
+
+void ai_set_ponder(bool enabled) {
+    ponder_enabled = enabled;
+    if (!enabled && search_ponder) ai_cancel();
+}
+
+bool ai_start_ponder(const Position *pos, const KeyHistory *history, const SearchResult *last, const SearchLimits *limits) {
+    if (!ponder_enabled || !last->has_ponder || search_status == AI_SEARCH_RUNNING) return false;
+
+    // Search the position after the predicted reply, with pos in its history
+    Position next = *pos;
+    Undo undo;
+    make_move(&next, last->ponder_move, &undo);
+    Move m;
+    if (!has_legal_moves(&next) || book_move(&next, &m)) return false;   // nothing to think about
+    KeyHistory next_history;
+    if (history) next_history = *history;
+    else keys_clear(&next_history);
+    keys_push(&next_history, pos->key, next.halfmove);
+
+    copy_search_input(&next, &next_history, limits);
+    search_ponder = true;
+    ponder_key = next.key;
+    if (!launch_search_thread()) {
+        search_ponder = false;
+        return false;
+    }
+    return true;
+}
+
+bool ai_opponent_moved(const Position *pos, const KeyHistory *history, const SearchLimits *limits) {
+    if (search_status == AI_SEARCH_RUNNING && search_ponder) {
+        if (pos->key == ponder_key && pos->side == search_pos.side) {
+            search_ponder = false;   // ponder hit: the running search goes on the clock
+            return true;
+        }
+        ai_cancel();
+    }
+    return ai_start_search(pos, history, limits);
+}
+
+AISearchStatus ai_poll_result(SearchResult *result) {
+    if (search_status != AI_SEARCH_RUNNING) return AI_SEARCH_IDLE;
+    if (search_ponder) return AI_SEARCH_PONDERING;
+    pthread_mutex_lock(&search_lock);
+    bool finished = search_finished;
+    pthread_mutex_unlock(&search_lock);
+    if (!finished) return AI_SEARCH_RUNNING;
+
+    if (search_threaded) pthread_join(search_thread, NULL);
+    search_status = AI_SEARCH_IDLE;
+    if (!search_found) return AI_SEARCH_NO_MOVE;
+    *result = search_result;
+    return AI_SEARCH_DONE;
+}
+
+int ai_search_lines(SearchLine *lines, int max) {
+    pthread_mutex_lock(&search_lock);
+    int count = search_line_count < max ? search_line_count : max;
+    memcpy(lines, search_lines, (size_t)count * sizeof(SearchLine));
+    pthread_mutex_unlock(&search_lock);
+    return count;
+}
+
+bool ai_search_stats(SearchStats *stats) {
+    pthread_mutex_lock(&search_lock);
+    bool has = search_has_stats;
+    if (has) *stats = search_stats;
+    pthread_mutex_unlock(&search_lock);
+    return has;
+}
+
+void ai_cancel(void) {
+    if (search_status != AI_SEARCH_RUNNING) return;
+    search_stop = true;
+    if (search_threaded) pthread_join(search_thread, NULL);
+    search_ponder = false;
+    search_status = AI_SEARCH_IDLE;
+}
@@ -0,0 +1,169 @@
+#include "attacks.h"
+
+Bitboard knight_attacks[64];
+Bitboard king_attacks[64];
+Bitboard pawn_attacks[2][64];
+Bitboard between_bb[64][64];
+Bitboard line_bb[64][64];
+Magic bishop_magics[64];
+Magic rook_magics[64];
+
+// Fancy magic tables: 5248 bishop and 102400 rook entries in total
+static Bitboard bishop_table[5248];
+static Bitboard rook_table[102400];
+
+// Offset tables as {rank step, file step}
+static const int knight_offsets[8][2] = {
+    {2, 1}, {1, 2}, {-1, 2}, {-2, 1}, {-2, -1}, {-1, -2}, {1, -2}, {2, -1}
+};
+static const int king_offsets[8][2] = {
+    {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}
+};
+static const int rook_dirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+static const int bishop_dirs[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+static Bitboard offset_attacks(int sq, const int offsets[8][2]) {
+    Bitboard att = 0;
+    int rank = sq >> 3, file = sq & 7;
+    for (int i = 0; i < 8; i++) {
+        int r = rank + offsets[i][0], f = file + offsets[i][1];
+        if (r >= 0 && r < 8 && f >= 0 && f < 8) att |= SQ_BB(r * 8 + f);
+    }
+    return att;
+}
+
+// Squares reached along each ray, up to and including the first blocker (table building only)
+static Bitboard ray_attacks(int sq, Bitboard occ, const int dirs[4][2]) {
+    Bitboard att = 0;
+    int rank = sq >> 3, file = sq & 7;
+    for (int d = 0; d < 4; d++) {
+        int r = rank + dirs[d][0], f = file + dirs[d][1];
+        for (; r >= 0 && r < 8 && f >= 0 && f < 8; r += dirs[d][0], f += dirs[d][1]) {
+            att |= SQ_BB(r * 8 + f);
+            if (occ & SQ_BB(r * 8 + f)) break;
+        }
+    }
+    return att;
+}
+
+// Blocker mask: ray squares minus the board edge each ray runs into
+static Bitboard relevant_mask(int sq, const int dirs[4][2]) {
+    Bitboard mask = 0;
+    int rank = sq >> 3, file = sq & 7;
+    for (int d = 0; d < 4; d++) {
+        int r = rank + dirs[d][0], f = file + dirs[d][1];
+        for (; r + dirs[d][0] >= 0 && r + dirs[d][0] < 8 && f + dirs[d][1] >= 0 && f + dirs[d][1] < 8;
+             r += dirs[d][0], f += dirs[d][1])
+            mask |= SQ_BB(r * 8 + f);
+    }
+    return mask;
+}
+
+// Magic multipliers, found offline by random trial against the fancy-magic layout above
+static const Bitboard bishop_magic_numbers[64] = {
+    0x40106000A1160020ULL, 0x0020010250810120ULL, 0x2010010220280081ULL, 0x002806004050C040ULL,
+    0x0002021018000000ULL, 0x2001112010000400ULL, 0x0881010120218080ULL, 0x1030820110010500ULL,
+    0x0000120222042400ULL, 0x2000020404040044ULL, 0x8000480094208000ULL, 0x0003422A02000001ULL,
+    0x000A220210100040ULL, 0x8004820202226000ULL, 0x0018234854100800ULL, 0x0100004042101040ULL,
+    0x0004001004082820ULL, 0x0010000810010048ULL, 0x1014004208081300ULL, 0x2080818802044202ULL,
+    0x0040880C00A00100ULL, 0x0080400200522010ULL, 0x0001000188180B04ULL, 0x0080249202020204ULL,
+    0x1004400004100410ULL, 0x00013100A0022206ULL, 0x2148500001040080ULL, 0x4241080011004300ULL,
+    0x4020848004002000ULL, 0x10101380D1004100ULL, 0x0008004422020284ULL, 0x01010A1041008080ULL,
+    0x0808080400082121ULL, 0x0808080400082121ULL, 0x0091128200100C00ULL, 0x0202200802010104ULL,
+    0x8C0A020200440085ULL, 0x01A0008080B10040ULL, 0x0889520080122800ULL, 0x100902022202010AULL,
+    0x04081A0816002000ULL, 0x0000681208005000ULL, 0x8170840041008802ULL, 0x0A00004200810805ULL,
+    0x0830404408210100ULL, 0x2602208106006102ULL, 0x1048300680802628ULL, 0x2602208106006102ULL,
+    0x0602010120110040ULL, 0x0941010801043000ULL, 0x000040440A210428ULL, 0x0008240020880021ULL,
+    0x0400002012048200ULL, 0x00AC102001210220ULL, 0x0220021002009900ULL, 0x84440C080A013080ULL,
+    0x0001008044200440ULL, 0x0004C04410841000ULL, 0x2000500104011130ULL, 0x1A0C010011C20229ULL,
+    0x0044800112202200ULL, 0x0434804908100424ULL, 0x0300404822C08200ULL, 0x48081010008A2A80ULL
+};
+static const Bitboard rook_magic_numbers[64] = {
+    0x0880004000108025ULL, 0x8040004010002008ULL, 0x2080200010008008ULL, 0x1100100008210004ULL,
+    0xC200209084020008ULL, 0x2100010004000208ULL, 0x0400081000822421ULL, 0x0200010422048844ULL,
+    0x0800800080400024ULL, 0x0001402000401000ULL, 0x3000801000802001ULL, 0x4400800800100083ULL,
+    0x0904802402480080ULL, 0x4040800400020080ULL, 0x0018808042000100ULL, 0x4040800080004100ULL,
+    0x0040048001458024ULL, 0x00A0004000205000ULL, 0x3100808010002000ULL, 0x4825010010000820ULL,
+    0x5004808008000401ULL, 0x2024818004000A00ULL, 0x0005808002000100ULL, 0x2100060004806104ULL,
+    0x0080400880008421ULL, 0x4062220600410280ULL, 0x010A004A00108022ULL, 0x0000100080080080ULL,
+    0x0021000500080010ULL, 0x0044000202001008ULL, 0x0000100400080102ULL, 0xC020128200040545ULL,
+    0x0080002000400040ULL, 0x0000804000802004ULL, 0x0000120022004080ULL, 0x010A386103001001ULL,
+    0x9010080080800400ULL, 0x8440020080800400ULL, 0x0004228824001001ULL, 0x000000490A000084ULL,
+    0x0080002000504000ULL, 0x200020005000C000ULL, 0x0012088020420010ULL, 0x0010010080080800ULL,
+    0x0085001008010004ULL, 0x0002000204008080ULL, 0x0040413002040008ULL, 0x0000304081020004ULL,
+    0x0080204000800080ULL, 0x3008804000290100ULL, 0x1010100080200080ULL, 0x2008100208028080ULL,
+    0x5000850800910100ULL, 0x8402019004680200ULL, 0x0120911028020400ULL, 0x0000008044010200ULL,
+    0x0020850200244012ULL, 0x0020850200244012ULL, 0x0000102001040841ULL, 0x140900040A100021ULL,
+    0x000200282410A102ULL, 0x000200282410A102ULL, 0x000200282410A102ULL, 0x4048240043802106ULL
+};
+
+// Fill one slider table: every blocker subset of each mask maps to its ray attacks
+static void init_magics(Magic magics[64], Bitboard *table, const Bitboard numbers[64], const int dirs[4][2]) {
+    Bitboard *next = table;
+    for (int sq = 0; sq < 64; sq++) {
+        Magic *m = &magics[sq];
+        m->mask = relevant_mask(sq, dirs);
+        m->magic = numbers[sq];
+        m->shift = 64 - bb_count(m->mask);
+        m->attacks = next;
+
+        // Carry-Rippler enumeration of every blocker subset of the mask
+        Bitboard b = 0;
+        do {
+            m->attacks[magic_index(m, b)] = ray_attacks(sq, b, dirs);
+            next++;
+            b = (b - m->mask) & m->mask;
+        } while (b);
+    }
+}
+
+void attacks_init(void) {
+    static bool initialized = false;
+    if (initialized) return;
+
+    for (int sq = 0; sq < 64; sq++) {
+        Bitboard b = SQ_BB(sq);
+        knight_attacks[sq] = offset_attacks(sq, knight_offsets);
+        king_attacks[sq] = offset_attacks(sq, king_offsets);
+        pawn_attacks[0][sq] = ((b << 7) & ~0x8080808080808080ULL) | ((b << 9) & ~0x0101010101010101ULL);
+        pawn_attacks[1][sq] = ((b >> 9) & ~0x8080808080808080ULL) | ((b >> 7) & ~0x0101010101010101ULL);
+    }
+    init_magics(bishop_magics, bishop_table, bishop_magic_numbers, bishop_dirs);
+    init_magics(rook_magics, rook_table, rook_magic_numbers, rook_dirs);
+
+    for (int a = 0; a < 64; a++) {
+        for (int b = 0; b < 64; b++) {
+            between_bb[a][b] = line_bb[a][b] = 0;
+            if (a == b) continue;
+            if (bishop_attacks(a, 0) & SQ_BB(b)) {
+                line_bb[a][b] = (bishop_attacks(a, 0) & bishop_attacks(b, 0)) | SQ_BB(a) | SQ_BB(b);
+                between_bb[a][b] = bishop_attacks(a, SQ_BB(b)) & bishop_attacks(b, SQ_BB(a));
+            } else if (rook_attacks(a, 0) & SQ_BB(b)) {
+                line_bb[a][b] = (rook_attacks(a, 0) & rook_attacks(b, 0)) | SQ_BB(a) | SQ_BB(b);
+                between_bb[a][b] = rook_attacks(a, SQ_BB(b)) & rook_attacks(b, SQ_BB(a));
+            }
+        }
+    }
+    initialized = true;
+}
+
+Bitboard attackers_to(const Position *pos, int sq, Bitboard occ) {
+    return (pawn_attacks[1][sq] & pos_pieces(pos, 1, W_PAWN))
+         | (pawn_attacks[0][sq] & pos_pieces(pos, -1, W_PAWN))
+         | (knight_attacks[sq] & pos->by_type[W_KNIGHT])
+         | (king_attacks[sq] & pos->by_type[W_KING])
+         | (bishop_attacks(sq, occ) & (pos->by_type[W_BISHOP] | pos->by_type[W_QUEEN]))
+         | (rook_attacks(sq, occ) & (pos->by_type[W_ROOK] | pos->by_type[W_QUEEN]));
+}
+
+bool square_attacked(const Position *pos, int sq, int by_color) {
+    Bitboard them = pos->by_color[COLOR_IDX(by_color)];
+    Bitboard occ = pos->by_type[EMPTY];
+    if (pawn_attacks[COLOR_IDX(-by_color)][sq] & pos->by_type[W_PAWN] & them) return true;
+    if (knight_attacks[sq] & pos->by_type[W_KNIGHT] & them) return true;
+    if (king_attacks[sq] & pos->by_type[W_KING] & them) return true;
+    Bitboard queens = pos->by_type[W_QUEEN];
+    if (bishop_attacks(sq, occ) & (pos->by_type[W_BISHOP] | queens) & them) return true;
+    if (rook_attacks(sq, occ) & (pos->by_type[W_ROOK] | queens) & them) return true;
+    return false;
+}
@@ -0,0 +1,122 @@
+#include "book.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const uint8_t *book_data = NULL;
+static size_t book_size = 0;      // bytes mapped
+static size_t book_count = 0;     // records
+
+bool book_open(const char *path) {
+    book_close();
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < BOOK_ENTRY_SIZE || st.st_size % BOOK_ENTRY_SIZE != 0) {
+        fprintf(stderr, "Warning: %s is not an opening book, ignoring it.\n", path);
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "Warning: could not map opening book %s.\n", path);
+        return false;
+    }
+    book_data = data;
+    book_size = (size_t)st.st_size;
+    book_count = book_size / BOOK_ENTRY_SIZE;
+    return true;
+}
+
+void book_close(void) {
+    if (book_data) munmap((void *)book_data, book_size);
+    book_data = NULL;
+    book_size = 0;
+    book_count = 0;
+}
+
+bool book_loaded(void) {
+    return book_data != NULL;
+}
+
+static uint64_t read_be(const uint8_t *p, int bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; i++) v = (v << 8) | p[i];
+    return v;
+}
+
+static void write_be(uint8_t *p, uint64_t v, int bytes) {
+    for (int i = bytes - 1; i >= 0; i--) {
+        p[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+void book_entry_read(const uint8_t in[BOOK_ENTRY_SIZE], BookEntry *e) {
+    e->key = read_be(in, 8);
+    e->move = (uint16_t)read_be(in + 8, 2);
+    e->weight = (uint16_t)read_be(in + 10, 2);
+    e->learn = (uint32_t)read_be(in + 12, 4);
+}
+
+void book_entry_write(const BookEntry *e, uint8_t out[BOOK_ENTRY_SIZE]) {
+    write_be(out, e->key, 8);
+    write_be(out + 8, e->move, 2);
+    write_be(out + 10, e->weight, 2);
+    write_be(out + 12, e->learn, 4);
+}
+
+// Polyglot promotion codes: 1 knight, 2 bishop, 3 rook, 4 queen
+static const uint8_t promo_code[7] = {[W_KNIGHT] = 1, [W_BISHOP] = 2, [W_ROOK] = 3, [W_QUEEN] = 4};
+
+uint16_t book_encode_move(Move m) {
+    int from = MOVE_FROM(m), to = MOVE_TO(m);
+    if (m.flags & MOVE_CASTLE) to = (from & ~7) | (m.tc == 6 ? 7 : 0);
+    return (uint16_t)((to & 7) | (to >> 3) << 3 | (from & 7) << 6 | (from >> 3) << 9 | promo_code[m.promo] << 12);
+}
+
+bool book_decode_move(const Position *pos, uint16_t move, Move *out) {
+    Move moves[MAX_MOVES];
+    int count = generate_moves(pos, moves);
+    for (int i = 0; i < count; i++) {
+        if (book_encode_move(moves[i]) == move) {
+            *out = moves[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool book_probe(const Position *pos, Move *out) {
+    if (!book_data) return false;
+
+    // First record with the position's key
+    size_t lo = 0, hi = book_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (read_be(book_data + mid * BOOK_ENTRY_SIZE, 8) < pos->key) lo = mid + 1;
+        else hi = mid;
+    }
+
+    // Pick among its moves in proportion to weight; moves the position does
+    // not allow (a key collision or a stale book) are skipped
+    Move chosen = {0};
+    uint32_t total = 0;
+    bool found = false;
+    for (size_t i = lo; i < book_count; i++) {
+        BookEntry e;
+        book_entry_read(book_data + i * BOOK_ENTRY_SIZE, &e);
+        if (e.key != pos->key) break;
+        Move m;
+        if (e.weight == 0 || !book_decode_move(pos, e.move, &m)) continue;
+        total += e.weight;
+        if ((uint32_t)rand() % total < e.weight) chosen = m;
+        found = true;
+    }
+    if (found) *out = chosen;
+    return found;
+}
@@ -1,5 +1,6 @@
 #include "chess_ai.h"
 #include "chess_logic.h"
+#include "movegen.h"
 #include "models.h"
 #include <stdlib.h>
 #include <stdio.h>
@@ -7,8 +8,6 @@
 #include <string.h>
 #include <float.h>
 
-#define MAX_MOVES 256
-
 // Piece values
 static const float piece_value[7] = {0, 1.0f, 5.0f, 3.0f, 3.0f, 9.0f, 100.0f}; // EMPTY=0, PAWN=1, ROOK=5, KNIGHT=3, BISHOP=3, QUEEN=9, KING=100
 
@@ -27,49 +26,28 @@ float evaluate_board(int board[8][8], int color) {
     return score * color;
 }
 
-// Move struct
-typedef struct {
-    int fr, fc, tr, tc;
-} Move;
-
 // Generates all valid moves for 'color', returns count, fills moves array.
 static int generate_all_valid_moves(int board[8][8], int color, Move moves[MAX_MOVES]) {
-    int count = 0;
-    for (int fr = 0; fr < 8; fr++) for (int fc = 0; fc < 8; fc++) {
-        int piece = board[fr][fc];
-        if (piece == EMPTY || ((piece > 0) != (color > 0))) continue;
-        for (int tr = 0; tr < 8; tr++) for (int tc = 0; tc < 8; tc++) {
-            if (is_valid_move(board, fr, fc, tr, tc)) {
-                if (count < MAX_MOVES)
-                    moves[count++] = (Move){fr, fc, tr, tc};
-            }
-        }
-    }
-    return count;
+    Position pos;
+    current_position(board, &pos);
+    pos.side = (int8_t)color;
+    return generate_moves(&pos, moves);
 }
 
 // Minimax with alpha-beta pruning
 float minimax(int board[8][8], int depth, float alpha, float beta, int maximizingPlayer, int color, int *out_fr, int *out_fc, int *out_tr, int *out_tc) {
     int current_color = maximizingPlayer ? color : -color;
 
-    // Detect endgame
-    if (depth == 0 || !has_valid_moves(board, current_color)) {
-        float eval = evaluate_board(board, color);
-        int in_check = is_in_check(board, current_color);
-        if (!has_valid_moves(board, current_color)) {
-            if (in_check)
-                eval = (current_color == color) ? -999.0f : 999.0f; // If current color is checkmated, bad for them
-            else
-                eval = 0.0f; // stalemate
-        }
-        return eval;
-    }
-
     Move moves[MAX_MOVES];
     int move_count = generate_all_valid_moves(board, current_color, moves);
 
-    // If no moves, return evaluation
-    if (move_count == 0)
+    // Detect endgame
+    if (move_count == 0) {
+        if (is_in_check(board, current_color))
+            return (current_color == color) ? -999.0f : 999.0f; // If current color is checkmated, bad for them
+        return 0.0f; // stalemate
+    }
+    if (depth == 0)
         return evaluate_board(board, color);
 
     int best_indices[MAX_MOVES];
@@ -86,8 +64,8 @@ float minimax(int board[8][8], int depth, float alpha, float beta, int maximizin
         tmp_board[tr][tc] = moved_piece;
         tmp_board[fr][fc] = EMPTY;
         // Pawn promotion
-        if ((moved_piece == W_PAWN && tr == 0) || (moved_piece == B_PAWN && tr == 7))
-            tmp_board[tr][tc] = (moved_piece > 0) ? W_QUEEN : B_QUEEN;
+        if (moves[i].promo != EMPTY)
+            tmp_board[tr][tc] = (moved_piece > 0) ? moves[i].promo : -moves[i].promo;
 
         float eval = minimax(tmp_board, depth-1, alpha, beta, !maximizingPlayer, color, NULL, NULL, NULL, NULL);
 
@@ -1,51 +1,65 @@
 #include "chess_logic.h"
+#include "attacks.h"
+#include "movegen.h"
 #include "models.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
-// === Turn State ===
-Turn current_turn = WHITE_TURN;
-
-// Special move state as before ...
-static bool white_king_moved = false;
-static bool black_king_moved = false;
-static bool white_rook_moved[2] = {false, false};
-static bool black_rook_moved[2] = {false, false};
-static int last_pawn_doublemove_row = -1, last_pawn_doublemove_col = -1;
-static int last_pawn_doublemove_turn = 0; // 0: none, >0: turn count
-
-void reset_move_state() {
-    white_king_moved = false;
-    black_king_moved = false;
-    white_rook_moved[0] = white_rook_moved[1] = false;
-    black_rook_moved[0] = black_rook_moved[1] = false;
-    last_pawn_doublemove_row = -1; last_pawn_doublemove_col = -1;
-    last_pawn_doublemove_turn = 0;
+void game_reset(GameContext *game) {
+    memset(game, 0, sizeof(*game));
+    game->turn = WHITE_TURN;
+    game->ep_row = -1;
+    game->ep_col = -1;
+    keys_clear(&game->history);
 }
-void update_move_state(int fr, int fc, int tr, int tc, int movedPiece) {
-    if (movedPiece == W_KING) white_king_moved = true;
-    if (movedPiece == B_KING) black_king_moved = true;
-    if (movedPiece == W_ROOK) {
-        if (fr == 7 && fc == 0) white_rook_moved[0] = true;
-        if (fr == 7 && fc == 7) white_rook_moved[1] = true;
-    }
-    if (movedPiece == B_ROOK) {
-        if (fr == 0 && fc == 0) black_rook_moved[0] = true;
-        if (fr == 0 && fc == 7) black_rook_moved[1] = true;
+
+void game_update_move_state(GameContext *game, int fr, int fc, int tr, int tc, int movedPiece) {
+    int ci = COLOR_IDX(movedPiece);
+    int home_row = (movedPiece > 0) ? 7 : 0;
+    if (abs(movedPiece) == W_KING) game->king_moved[ci] = true;
+    if (abs(movedPiece) == W_ROOK && fr == home_row) {
+        if (fc == 0) game->rook_moved[ci][0] = true;
+        if (fc == 7) game->rook_moved[ci][1] = true;
     }
     if (abs(movedPiece) == W_PAWN && abs(tr - fr) == 2) {
-        last_pawn_doublemove_row = tr;
-        last_pawn_doublemove_col = tc;
-        last_pawn_doublemove_turn = 1;
+        game->ep_row = tr;
+        game->ep_col = tc;
     } else {
-        last_pawn_doublemove_row = -1;
-        last_pawn_doublemove_col = -1;
-        last_pawn_doublemove_turn = 0;
+        game->ep_row = -1;
+        game->ep_col = -1;
     }
 }
 
+void game_position(const GameContext *game, int board[8][8], Position *pos) {
+    int castling = 0;
+    if (!game->king_moved[0]) {
+        if (!game->rook_moved[0][1]) castling |= CASTLE_WK;
+        if (!game->rook_moved[0][0]) castling |= CASTLE_WQ;
+    }
+    if (!game->king_moved[1]) {
+        if (!game->rook_moved[1][1]) castling |= CASTLE_BK;
+        if (!game->rook_moved[1][0]) castling |= CASTLE_BQ;
+    }
+    int ep_square = SQ_NONE;
+    if (game->ep_row >= 0) {
+        // The en-passant target is the square the pawn skipped over
+        int pawn = board[game->ep_row][game->ep_col];
+        int skipped_row = game->ep_row + ((pawn > 0) ? 1 : -1);
+        ep_square = SQ(skipped_row, game->ep_col);
+    }
+    position_from_board(pos, board, game->turn, castling, ep_square);
+    pos->halfmove = (uint8_t)(game->halfmove < 255 ? game->halfmove : 255);
+    pos->fullmove = (uint16_t)(1 + game->ply / 2);
+}
+
+GameStatus game_status(const GameContext *game, int board[8][8]) {
+    Position pos;
+    game_position(game, board, &pos);
+    return position_status(&pos, &game->history);
+}
+
 // --- Utility ---
 bool is_empty(int board[8][8], int row, int col) {
     return board[row][col] == EMPTY;
@@ -74,63 +88,28 @@ bool is_path_clear(int board[8][8], int fr, int fc, int tr, int tc) {
 }
 
 // --- Check Detection ---
-static void find_king(int board[8][8], int color, int *krow, int *kcol) {
-    int king = (color == 1) ? W_KING : B_KING;
-    for (int r = 0; r < 8; r++)
-        for (int c = 0; c < 8; c++)
-            if (board[r][c] == king) {
-                *krow = r; *kcol = c; return;
-            }
-    *krow = -1; *kcol = -1;
-}
-
 // Returns true if the king of `color` is under attack by any opponent piece.
 bool is_in_check(int board[8][8], int color) {
-    int krow, kcol;
-    find_king(board, color, &krow, &kcol);
-    if (krow == -1) return false; // Defensive fallback
-
-    // For each opponent piece, check if it can move to king's square (ignoring king safety)
-    for (int r=0; r<8; r++) for (int c=0; c<8; c++) {
-        int piece = board[r][c];
-        if (piece == EMPTY || ((piece > 0) == (color > 0))) continue;
-        // Use special: is_valid_move_attack for pawns (because they only attack diagonally)
-        int abs_piece = abs(piece);
-        if (abs_piece == W_PAWN) {
-            int dir = (piece > 0) ? -1 : 1;
-            if (krow == r + dir && (kcol == c - 1 || kcol == c + 1))
-                return true;
-        } else {
-            // For others, use is_valid_move ignoring king safety (no recursion!)
-            if (is_valid_move_no_check(board, r, c, krow, kcol)) return true;
-        }
-    }
-    return false;
+    Position pos;
+    position_from_board(&pos, board, color, 0, SQ_NONE);
+    int ksq = pos.king_sq[COLOR_IDX(color)];
+    if (ksq == SQ_NONE) return false; // Defensive fallback
+    return square_attacked(&pos, ksq, -color);
 }
 
 // Valid move for rules, but does NOT check for leaving king in check (to avoid infinite recursion)
 bool is_valid_move_no_check(int board[8][8], int fr, int fc, int tr, int tc);
 
 // Returns true if the player of color has any valid legal move (not leaving king in check)
-bool has_valid_moves(int board[8][8], int color) {
-    for (int fr = 0; fr < 8; fr++) for (int fc = 0; fc < 8; fc++) {
-        int piece = board[fr][fc];
-        if (piece == EMPTY || ((piece > 0) != (color > 0))) continue;
-        for (int tr = 0; tr < 8; tr++) for (int tc = 0; tc < 8; tc++) {
-            // For castling, only try king's original square and two squares to the side
-            if (abs(piece) == W_KING && fr == tr && abs(tc - fc) == 2 && fc == 4) {
-                if (is_valid_move(board, fr, fc, tr, tc))
-                    return true;
-            } else if (is_valid_move(board, fr, fc, tr, tc)) {
-                return true;
-            }
-        }
-    }
-    return false;
+bool game_has_valid_moves(const GameContext *game, int board[8][8], int color) {
+    Position pos;
+    game_position(game, board, &pos);
+    pos.side = (int8_t)color;
+    return has_legal_moves(&pos);
 }
 
 // --- Special move helpers (as before, unchanged) ---
-bool can_castle(int board[8][8], int fr, int fc, int tr, int tc) {
+bool game_can_castle(const GameContext *game, int board[8][8], int fr, int fc, int tr, int tc) {
     int piece = board[fr][fc];
     if (!(abs(piece) == W_KING && fr == tr)) return false;
     int color = (piece > 0) ? 1 : -1;
@@ -140,13 +119,8 @@ bool can_castle(int board[8][8], int fr, int fc, int tr, int tc) {
     int kingside = (tc - fc) > 0;
     int rook_col = kingside ? 7 : 0;
     int rook_piece = board[fr][rook_col];
-    if (color == 1) {
-        if (white_king_moved) return false;
-        if (white_rook_moved[kingside ? 1 : 0]) return false;
-    } else {
-        if (black_king_moved) return false;
-        if (black_rook_moved[kingside ? 1 : 0]) return false;
-    }
+    if (game->king_moved[COLOR_IDX(color)]) return false;
+    if (game->rook_moved[COLOR_IDX(color)][kingside ? 1 : 0]) return false;
     if ((color == 1 && rook_piece != W_ROOK) || (color == -1 && rook_piece != B_ROOK)) return false;
     // Path between king and rook must be clear
     int c1 = kingside ? fc+1 : rook_col+1;
@@ -155,28 +129,24 @@ bool can_castle(int board[8][8], int fr, int fc, int tr, int tc) {
         if (!is_empty(board, fr, c)) return false;
     }
     // New: King cannot castle through, into, or out of check
+    Position pos;
+    position_from_board(&pos, board, color, 0, SQ_NONE);
     int kstep = (kingside ? 1 : -1);
     for (int i = 0; i <= 2; i++) {
-        int tcol = fc + i*kstep;
-        // Simulate king at each square
-        int temp_board[8][8];
-        memcpy(temp_board, board, sizeof(temp_board));
-        temp_board[fr][fc] = EMPTY;
-        temp_board[fr][tcol] = piece;
-        if (is_in_check(temp_board, color)) return false;
+        if (square_attacked(&pos, SQ(fr, fc + i*kstep), -color)) return false;
     }
     return true;
 }
 
-bool can_en_passant(int board[8][8], int fr, int fc, int tr, int tc) {
+bool game_can_en_passant(const GameContext *game, int board[8][8], int fr, int fc, int tr, int tc) {
     int piece = board[fr][fc];
     if (abs(piece) != W_PAWN) return false;
     int dir = (piece > 0) ? -1 : 1;
     if (abs(tc - fc) != 1 || tr - fr != dir) return false;
-    if (tr == last_pawn_doublemove_row && tc == last_pawn_doublemove_col &&
-        last_pawn_doublemove_turn == 1 &&
-        abs(board[last_pawn_doublemove_row - dir][tc]) == W_PAWN &&
-        (board[last_pawn_doublemove_row - dir][tc] * piece) < 0)
+    // Capturing pawn stands beside the pawn that just moved two squares and lands behind it
+    if (fr == game->ep_row && tc == game->ep_col &&
+        abs(board[fr][tc]) == W_PAWN &&
+        (board[fr][tc] * piece) < 0)
     {
         return true;
     }
@@ -232,97 +202,44 @@ bool is_valid_move_no_check(int board[8][8], int fr, int fc, int tr, int tc) {
 }
 
 // This is now the "full rules" move validator: move must not leave own king in check!
-bool is_valid_move(int board[8][8], int fr, int fc, int tr, int tc) {
+// Backed by the legal generator, so castling, en passant and pins follow the same rules as the AI.
+bool game_is_valid_move(const GameContext *game, int board[8][8], int fr, int fc, int tr, int tc) {
     if (fr < 0 || fr > 7 || fc < 0 || fc > 7 || tr < 0 || tr > 7 || tc < 0 || tc > 7)
         return false;
-    int piece = board[fr][fc];
-    if (piece == EMPTY) return false;
-    if (fr == tr && fc == tc) return false;
-    // Only allow correct color to move
-    if ((current_turn == WHITE_TURN && piece < 0) ||
-        (current_turn == BLACK_TURN && piece > 0))
-        return false;
-    // No capturing same color
-    if (is_same_color(board, fr, fc, tr, tc)) return false;
-
-    int dr = tr - fr, dc = tc - fc;
-    int abs_dr = abs(dr), abs_dc = abs(dc);
-    int dir = (piece > 0) ? -1 : 1;
+    if (board[fr][fc] == EMPTY) return false;
 
-    // --- Special moves first ---
-    if (abs(piece) == W_KING && abs(tc - fc) == 2 && fr == tr) {
-        if (!can_castle(board, fr, fc, tr, tc)) return false;
-        // Ensure king not in check at any square passed
-        return true;
-    }
-    if (abs(piece) == W_PAWN && can_en_passant(board, fr, fc, tr, tc)) {
-        // Simulate the capture and make sure king is not in check after
-        int temp[8][8]; memcpy(temp, board, sizeof(temp));
-        int dir = (piece > 0) ? 1 : -1;
-        temp[tr][tc] = piece;
-        temp[fr][fc] = EMPTY;
-        temp[tr+dir][tc] = EMPTY;
-        int color = (piece > 0) ? 1 : -1;
-        if (is_in_check(temp, color)) return false;
-        return true;
+    Position pos;
+    game_position(game, board, &pos);
+    Move moves[MAX_MOVES];
+    int count = generate_moves(&pos, moves);
+    for (int i = 0; i < count; i++) {
+        if (moves[i].fr == fr && moves[i].fc == fc && moves[i].tr == tr && moves[i].tc == tc)
+            return true;
     }
-
-    // --- Normal moves ---
-    bool move_ok = false;
-    switch (abs(piece)) {
-        case W_PAWN: {
-            if (dc == 0 && is_empty(board, tr, tc)) {
-                if (dr == dir) move_ok = true;
-                if (((piece > 0 && fr == 6) || (piece < 0 && fr == 1)) && dr == 2*dir) {
-                    int midr = fr + dir;
-                    if (is_empty(board, midr, fc)) move_ok = true;
-                }
-            }
-            if (abs_dc == 1 && dr == dir && is_opponent_piece(board, fr, fc, tr, tc)) move_ok = true;
-            break;
-        }
-        case W_ROOK:
-            if ((dr == 0 || dc == 0) && is_path_clear(board, fr, fc, tr, tc)) move_ok = true;
-            break;
-        case W_BISHOP:
-            if (abs_dr == abs_dc && is_path_clear(board, fr, fc, tr, tc)) move_ok = true;
-            break;
-        case W_QUEEN:
-            if (((dr == 0 || dc == 0) || (abs_dr == abs_dc)) && is_path_clear(board, fr, fc, tr, tc)) move_ok = true;
-            break;
-        case W_KNIGHT:
-            if ((abs_dr == 2 && abs_dc == 1) || (abs_dr == 1 && abs_dc == 2)) move_ok = true;
-            break;
-        case W_KING:
-            if (abs_dr <= 1 && abs_dc <= 1) move_ok = true;
-            break;
-        default:
-            move_ok = false;
-    }
-    if (!move_ok) return false;
-
-    // --- Simulate the move and check king safety ---
-    int temp[8][8]; memcpy(temp, board, sizeof(temp));
-    temp[tr][tc] = piece;
-    temp[fr][fc] = EMPTY;
-    if (abs(piece) == W_PAWN && ((piece > 0 && tr == 0) || (piece < 0 && tr == 7))) {
-        // Promote for check check
-        temp[tr][tc] = (piece > 0) ? W_QUEEN : B_QUEEN;
-    }
-    int color = (piece > 0) ? 1 : -1;
-    if (is_in_check(temp, color)) return false;
-    return true;
+    return false;
 }
 
 // --- Move Application (with check/checkmate/stalemate logging) ---
-void apply_move(int board[8][8], int fr, int fc, int tr, int tc) {
+void game_apply_move(GameContext *game, int board[8][8], int fr, int fc, int tr, int tc) {
+    game_apply_promotion(game, board, fr, fc, tr, tc, EMPTY);
+}
+
+void game_apply_promotion(GameContext *game, int board[8][8], int fr, int fc, int tr, int tc, int promo) {
     int piece = board[fr][fc];
-    if (!is_valid_move(board, fr, fc, tr, tc)) {
+    if (!game_is_valid_move(game, board, fr, fc, tr, tc)) {
         printf("Invalid move for piece: %s from (%d,%d) to (%d,%d)\n",
                piece_name(piece), fr, fc, tr, tc);
         return;
     }
 
+    // Draw-rule bookkeeping: the position left behind and the halfmove clock
+    Position before;
+    game_position(game, board, &before);
+    bool irreversible = abs(piece) == W_PAWN || board[tr][tc] != EMPTY;
+    game->halfmove = irreversible ? 0 : game->halfmove + 1;
+    keys_push(&game->history, before.key, game->halfmove);
+    game->ply++;
+
     // --- Special moves ---
     if (abs(piece) == W_KING && abs(tc - fc) == 2 && fr == tr) {
         int kingside = (tc - fc) > 0;
@@ -331,53 +248,110 @@ void apply_move(int board[8][8], int fr, int fc, int tr, int tc) {
         board[fr][fc] = EMPTY;
         board[fr][rook_to] = board[fr][rook_from];
         board[fr][rook_from] = EMPTY;
-        update_move_state(fr, fc, tr, tc, piece);
-        update_move_state(fr, rook_from, fr, rook_to, board[fr][rook_to]);
+        game_update_move_state(game, fr, fc, tr, tc, piece);
+        game_update_move_state(game, fr, rook_from, fr, rook_to, board[fr][rook_to]);
         printf("Castling performed (%s King-side)\n",
                (kingside ? (piece > 0 ? "White" : "Black") : (piece > 0 ? "White Queen-side" : "Black Queen-side")));
         // Next turn
-        current_turn = (current_turn == WHITE_TURN) ? BLACK_TURN : WHITE_TURN;
+        game->turn = (game->turn == WHITE_TURN) ? BLACK_TURN : WHITE_TURN;
         goto end_of_move_checks;
     }
     // En passant
-    if (abs(piece) == W_PAWN && can_en_passant(board, fr, fc, tr, tc)) {
+    if (abs(piece) == W_PAWN && game_can_en_passant(game, board, fr, fc, tr, tc)) {
         board[tr][tc] = piece;
         board[fr][fc] = EMPTY;
         int dir = (piece > 0) ? 1 : -1;
         int cap_row = tr + dir, cap_col = tc;
         printf("En Passant capture at (%d,%d)\n", cap_row, cap_col);
         board[cap_row][cap_col] = EMPTY;
-        update_move_state(fr, fc, tr, tc, piece);
-        current_turn = (current_turn == WHITE_TURN) ? BLACK_TURN : WHITE_TURN;
+        game_update_move_state(game, fr, fc, tr, tc, piece);
+        game->turn = (game->turn == WHITE_TURN) ? BLACK_TURN : WHITE_TURN;
         goto end_of_move_checks;
     }
     // --- Normal move ---
     int captured = board[tr][tc];
     board[tr][tc] = piece;
     board[fr][fc] = EMPTY;
-    update_move_state(fr, fc, tr, tc, piece);
+    game_update_move_state(game, fr, fc, tr, tc, piece);
 
     // Promotion
     if (abs(piece) == W_PAWN && ((piece > 0 && tr == 0) || (piece < 0 && tr == 7))) {
-        promote_pawn(board, tr, tc);
+        if (promo >= W_ROOK && promo < W_QUEEN) {
+            board[tr][tc] = piece > 0 ? promo : -promo;
+            printf("Pawn promoted to %s at (%d,%d)\n", piece_name(board[tr][tc]), tr, tc);
+        } else {
+            promote_pawn(board, tr, tc);
+        }
     }
 
     printf("Moved %s from (%d,%d) to (%d,%d)%s\n",
         piece_name(piece), fr, fc, tr, tc,
         (captured != EMPTY ? " (capture)" : ""));
-    current_turn = (current_turn == WHITE_TURN) ? BLACK_TURN : WHITE_TURN;
+    game->turn = (game->turn == WHITE_TURN) ? BLACK_TURN : WHITE_TURN;
 
 end_of_move_checks:
-    // After move: check/checkmate/stalemate detection
-    int next_color = (current_turn == WHITE_TURN) ? 1 : -1;
-    if (is_in_check(board, next_color)) {
+    // After move: check, mate and draw detection
+    int next_color = (game->turn == WHITE_TURN) ? 1 : -1;
+    GameStatus status = game_status(game, board);
+    if (status != GAME_ONGOING)
+        printf("%s!\n", game_status_name(status));
+    else if (is_in_check(board, next_color))
         printf("Check!\n");
-        if (!has_valid_moves(board, next_color)) {
-            printf("Checkmate!\n");
-        }
-    } else {
-        if (!has_valid_moves(board, next_color)) {
-            printf("Stalemate!\n");
-        }
-    }
-}
\ No newline at end of file
+}
+
+// --- Process-wide game for the single-game wrappers ---
+// current_turn stays a plain global for existing callers; the wrappers copy
+// it into the context on the way in and back out after a move.
+Turn current_turn = WHITE_TURN;
+static GameContext global_game = {.turn = WHITE_TURN, .ep_row = -1, .ep_col = -1};
+
+static GameContext *global_context(void) {
+    global_game.turn = current_turn;
+    return &global_game;
+}
+
+void reset_move_state() {
+    game_reset(&global_game);
+    global_game.turn = current_turn;
+}
+
+void update_move_state(int fr, int fc, int tr, int tc, int movedPiece) {
+    game_update_move_state(global_context(), fr, fc, tr, tc, movedPiece);
+}
+
+void current_position(int board[8][8], Position *pos) {
+    game_position(global_context(), board, pos);
+}
+
+bool is_valid_move(int board[8][8], int fr, int fc, int tr, int tc) {
+    return game_is_valid_move(global_context(), board, fr, fc, tr, tc);
+}
+
+void apply_move(int board[8][8], int fr, int fc, int tr, int tc) {
+    apply_promotion(board, fr, fc, tr, tc, EMPTY);
+}
+
+void apply_promotion(int board[8][8], int fr, int fc, int tr, int tc, int promo) {
+    game_apply_promotion(global_context(), board, fr, fc, tr, tc, promo);
+    current_turn = global_game.turn;
+}
+
+bool can_castle(int board[8][8], int fr, int fc, int tr, int tc) {
+    return game_can_castle(global_context(), board, fr, fc, tr, tc);
+}
+
+bool can_en_passant(int board[8][8], int fr, int fc, int tr, int tc) {
+    return game_can_en_passant(global_context(), board, fr, fc, tr, tc);
+}
+
+bool has_valid_moves(int board[8][8], int color) {
+    return game_has_valid_moves(global_context(), board, color);
+}
+
+GameStatus current_status(int board[8][8]) {
+    return game_status(global_context(), board);
+}
+
+const GameContext *current_game(void) {
+    return global_context();
+}
@@ -4,7 +4,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 
-VortexConfig vortex_config = {1024, 768, false, 1, 1.0f};
+VortexConfig vortex_config = {1024, 768, false, 1, 1.0f, 16, 1, 16, true, true};
 
 bool config_load(const char *filename) {
     FILE *f = fopen(filename, "r");
@@ -16,6 +16,11 @@ bool config_load(const char *filename) {
         if (sscanf(buf, "fullscreen: %d", (int*)&vortex_config.fullscreen) == 1) continue;
         if (sscanf(buf, "ai_difficulty: %d", &vortex_config.ai_difficulty) == 1) continue;
         if (sscanf(buf, "volume: %f", &vortex_config.volume) == 1) continue;
+        if (sscanf(buf, "hash_mb: %d", &vortex_config.hash_mb) == 1) continue;
+        if (sscanf(buf, "threads: %d", &vortex_config.threads) == 1) continue;
+        if (sscanf(buf, "book_depth: %d", &vortex_config.book_depth) == 1) continue;
+        if (sscanf(buf, "ponder: %d", (int*)&vortex_config.ponder) == 1) continue;
+        if (sscanf(buf, "nnue: %d", (int*)&vortex_config.nnue) == 1) continue;
     }
     fclose(f);
     return true;
@@ -23,9 +28,10 @@ bool config_load(const char *filename) {
 bool config_save(const char *filename) {
     FILE *f = fopen(filename, "w");
     if (!f) return false;
-    fprintf(f, "width: %d\nheight: %d\nfullscreen: %d\nai_difficulty: %d\nvolume: %.2f\n",
+    fprintf(f, "width: %d\nheight: %d\nfullscreen: %d\nai_difficulty: %d\nvolume: %.2f\nhash_mb: %d\nthreads: %d\nbook_depth: %d\nponder: %d\nnnue: %d\n",
         vortex_config.width, vortex_config.height, vortex_config.fullscreen,
-        vortex_config.ai_difficulty, vortex_config.volume);
+        vortex_config.ai_difficulty, vortex_config.volume, vortex_config.hash_mb,
+        vortex_config.threads, vortex_config.book_depth, vortex_config.ponder, vortex_config.nnue);
     fclose(f);
     return true;
 }
\ No newline at end of file
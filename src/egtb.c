@@ -0,0 +1,460 @@
+#include "egtb.h"
+#include "attacks.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+// Tables are indexed from the strong side's point of view, as if it were
+// White: [side to move][strong king][lone king][piece]... with 0 = strong side
+// to move. Pawnless tables keep only the strong king in the a1-d1-d4 triangle
+// (the other seven board symmetries map onto it); KPK can only mirror files.
+//
+// Each byte is 0 for a draw, DTM_ILLEGAL for an impossible position (or an
+// index that only mirrors another), or the plies to mate plus one: a win when
+// the strong side is to move, a loss when the lone king is.
+#define MAX_EXTRA 2
+#define DTM_ILLEGAL 255
+#define MAX_LEVELS 254
+#define FILE_MAGIC "VMEGTB01"
+
+typedef struct {
+    const char *name;
+    const char *file;
+    int extra;                  // pieces besides the two kings
+    int types[MAX_EXTRA];       // strong side's pieces, in index order
+    bool pawns;
+    size_t size;
+    uint8_t *dtm;
+    bool ready;                 // set with release order once dtm is complete
+} Table;
+
+static Table tables[EGTB_TABLES] = {
+    [EGTB_KPK]  = {"KPK",  "kpk.egtb",  1, {W_PAWN},             true},
+    [EGTB_KQK]  = {"KQK",  "kqk.egtb",  1, {W_QUEEN},            false},
+    [EGTB_KRK]  = {"KRK",  "krk.egtb",  1, {W_ROOK},             false},
+    [EGTB_KBNK] = {"KBNK", "kbnk.egtb", 2, {W_BISHOP, W_KNIGHT}, false},
+};
+
+typedef struct {
+    int wk, bk;                 // strong and lone king
+    int p[MAX_EXTRA];
+} Squares;
+
+// Strong king squares of the pawnless index: a1 b1 c1 d1 b2 c2 d2 c3 d3 d4
+static const int8_t triangle[10] = {0, 1, 2, 3, 9, 10, 11, 18, 19, 27};
+
+static bool is_ready(const Table *t) {
+    return __atomic_load_n(&t->ready, __ATOMIC_ACQUIRE);
+}
+
+// --- Indexing ---
+
+static int king_slots(const Table *t) {
+    return t->pawns ? 32 : 10;
+}
+
+static size_t table_size(const Table *t) {
+    size_t n = 2 * (size_t)king_slots(t) * 64;
+    for (int i = 0; i < t->extra; i++) n *= 64;
+    return n;
+}
+
+// sym bits: 1 mirrors files, 2 mirrors ranks, 4 swaps files and ranks (applied in that order)
+static int transform(int sq, int sym) {
+    if (sym & 1) sq ^= 7;
+    if (sym & 2) sq ^= 56;
+    if (sym & 4) sq = ((sq & 7) << 3) | (sq >> 3);
+    return sq;
+}
+
+static size_t encode(const Table *t, int stm, const Squares *s) {
+    int sym = 0, file = s->wk & 7, rank = s->wk >> 3;
+    if (file > 3) { sym |= 1; file = 7 - file; }
+    if (!t->pawns) {
+        if (rank > 3) { sym |= 2; rank = 7 - rank; }
+        if (rank > file) {
+            sym |= 4;
+            int tmp = rank; rank = file; file = tmp;
+        } else if (rank == file) {
+            // King on the diagonal: the first other piece off it picks the
+            // side, so every position has exactly one index
+            for (int i = -1; i < t->extra; i++) {
+                int sq = transform(i < 0 ? s->bk : s->p[i], sym);
+                if ((sq >> 3) == (sq & 7)) continue;
+                if ((sq >> 3) > (sq & 7)) sym |= 4;
+                break;
+            }
+        }
+    }
+    int slot = t->pawns ? rank * 4 + file : rank * 4 - rank * (rank - 1) / 2 + (file - rank);
+    size_t idx = ((size_t)stm * king_slots(t) + slot) * 64 + transform(s->bk, sym);
+    for (int i = 0; i < t->extra; i++) idx = idx * 64 + transform(s->p[i], sym);
+    return idx;
+}
+
+// Returns the side to move
+static int decode(const Table *t, size_t idx, Squares *s) {
+    for (int i = t->extra - 1; i >= 0; i--) {
+        s->p[i] = (int)(idx & 63);
+        idx >>= 6;
+    }
+    s->bk = (int)(idx & 63);
+    idx >>= 6;
+    int slot = (int)(idx % king_slots(t));
+    s->wk = t->pawns ? (slot / 4) * 8 + slot % 4 : triangle[slot];
+    return (int)(idx / king_slots(t));
+}
+
+// --- Board geometry, strong side moving up the board ---
+
+static Bitboard strong_pieces(const Table *t, const Squares *s) {
+    Bitboard b = 0;
+    for (int i = 0; i < t->extra; i++) b |= SQ_BB(s->p[i]);
+    return b;
+}
+
+static Bitboard piece_attacks(int type, int sq, Bitboard occ) {
+    switch (type) {
+        case W_PAWN:   return pawn_attacks[0][sq];
+        case W_KNIGHT: return knight_attacks[sq];
+        case W_BISHOP: return bishop_attacks(sq, occ);
+        case W_ROOK:   return rook_attacks(sq, occ);
+        case W_QUEEN:  return queen_attacks(sq, occ);
+        default:       return king_attacks[sq];
+    }
+}
+
+// Squares the lone king may not stand on. Lines are traced through the lone
+// king's own square, so it cannot step back along a checking line.
+static Bitboard strong_attacks(const Table *t, const Squares *s) {
+    Bitboard occ = strong_pieces(t, s) | SQ_BB(s->wk);
+    Bitboard att = king_attacks[s->wk];
+    for (int i = 0; i < t->extra; i++) att |= piece_attacks(t->types[i], s->p[i], occ);
+    return att;
+}
+
+static bool legal(const Table *t, int stm, const Squares *s) {
+    Bitboard occ = strong_pieces(t, s) | SQ_BB(s->wk) | SQ_BB(s->bk);
+    if (bb_count(occ) != 2 + t->extra) return false;
+    if (king_attacks[s->wk] & SQ_BB(s->bk)) return false;
+    for (int i = 0; i < t->extra; i++)
+        if (t->types[i] == W_PAWN && ((s->p[i] >> 3) == 0 || (s->p[i] >> 3) == 7)) return false;
+    // The side that just moved cannot have left the lone king in check
+    return stm == 1 || !(strong_attacks(t, s) & SQ_BB(s->bk));
+}
+
+// Lone king destinations; a capture of an undefended piece is among them
+static Bitboard lone_king_moves(const Table *t, const Squares *s) {
+    return king_attacks[s->bk] & ~strong_attacks(t, s);
+}
+
+// --- Retrograde construction ---
+
+typedef struct {
+    size_t *items;
+    size_t count, capacity;
+} IndexList;
+
+static bool list_push(IndexList *list, size_t idx) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 1024;
+        size_t *grown = realloc(list->items, capacity * sizeof(size_t));
+        if (!grown) return false;
+        list->items = grown;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = idx;
+    return true;
+}
+
+// Lone king to move, no capture available: lost once every move reaches a
+// position already won for the strong side
+static bool all_moves_lose(const Table *t, const uint8_t *dtm, const Squares *s) {
+    Bitboard moves = lone_king_moves(t, s);
+    while (moves) {
+        Squares child = *s;
+        child.bk = bb_pop_lsb(&moves);
+        uint8_t v = dtm[encode(t, 0, &child)];
+        if (v == 0 || v == DTM_ILLEGAL) return false;
+    }
+    return true;
+}
+
+// Wins by promotion, looked up in the KQK and KRK tables; 0 if none
+static int promotion_plies(const Table *t, const Squares *s) {
+    int best = 0;
+    for (int i = 0; i < t->extra; i++) {
+        int sq = s->p[i];
+        if (t->types[i] != W_PAWN || (sq >> 3) != 6 || sq + 8 == s->wk || sq + 8 == s->bk) continue;
+        for (EgtbTable target = EGTB_KQK; target <= EGTB_KRK; target++) {
+            Squares after = {s->wk, s->bk, {sq + 8}};
+            uint8_t v = tables[target].dtm[encode(&tables[target], 1, &after)];
+            if (v != 0 && v != DTM_ILLEGAL && (best == 0 || v < best)) best = v;
+        }
+    }
+    return best;   // lone king mated v - 1 plies after the promotion: v plies in all
+}
+
+// Builds t->dtm; the promotion tables must be ready for KPK
+static bool build(Table *t) {
+    uint8_t *dtm = calloc(t->size, 1);
+    uint8_t *drawn = calloc(t->size, 1);     // lone king can take a piece: never lost
+    IndexList *levels = calloc(MAX_LEVELS, sizeof(IndexList));
+    if (!dtm || !drawn || !levels) goto fail;
+
+    // Illegal positions, mates, and the positions a capture or promotion decides
+    for (size_t idx = 0; idx < t->size; idx++) {
+        Squares s;
+        int stm = decode(t, idx, &s);
+        if (encode(t, stm, &s) != idx || !legal(t, stm, &s)) {
+            dtm[idx] = DTM_ILLEGAL;
+        } else if (stm == 1) {
+            Bitboard moves = lone_king_moves(t, &s);
+            if (moves & strong_pieces(t, &s)) {
+                drawn[idx] = 1;
+            } else if (!moves && (strong_attacks(t, &s) & SQ_BB(s.bk))) {
+                dtm[idx] = 1;
+                if (!list_push(&levels[0], idx)) goto fail;
+            }
+        } else if (t->pawns) {
+            int plies = promotion_plies(t, &s);
+            // Queued unset: a quicker win found on the way may still claim it
+            if (plies > 0 && plies < MAX_LEVELS && !list_push(&levels[plies], idx)) goto fail;
+        }
+    }
+
+    // Level by level from the mates: a position lost in n plies makes every
+    // position that can move into it won in n + 1; a position won in n makes
+    // its predecessors lost in n + 1 once all their moves are won for the
+    // strong side. Levels are visited in order, so the first value set is the
+    // distance to mate.
+    for (int level = 0; level < MAX_LEVELS; level++) {
+        IndexList *list = &levels[level];
+        for (size_t i = 0; i < list->count; i++) {
+            size_t idx = list->items[i];
+            Squares s;
+            int stm = decode(t, idx, &s);
+            Bitboard occ = strong_pieces(t, &s) | SQ_BB(s.wk) | SQ_BB(s.bk);
+
+            if (stm == 0) {
+                if (dtm[idx] == 0) dtm[idx] = (uint8_t)(level + 1);   // promotion win
+                else if (dtm[idx] != level + 1) continue;
+                if (level + 1 >= MAX_LEVELS) continue;
+                // Undo the lone king's last move
+                Bitboard from = king_attacks[s.bk] & ~occ;
+                while (from) {
+                    Squares prev = s;
+                    prev.bk = bb_pop_lsb(&from);
+                    size_t pidx = encode(t, 1, &prev);
+                    if (dtm[pidx] != 0 || drawn[pidx] || !all_moves_lose(t, dtm, &prev)) continue;
+                    dtm[pidx] = (uint8_t)(level + 2);
+                    if (!list_push(&levels[level + 1], pidx)) goto fail;
+                }
+            } else {
+                if (level + 1 >= MAX_LEVELS) continue;
+                // Undo the strong side's last move: king first, then each piece
+                for (int j = -1; j < t->extra; j++) {
+                    int sq = j < 0 ? s.wk : s.p[j];
+                    Bitboard from;
+                    if (j < 0) {
+                        from = king_attacks[sq] & ~occ;
+                    } else if (t->types[j] == W_PAWN) {
+                        from = 0;
+                        if ((sq >> 3) >= 2 && !(occ & SQ_BB(sq - 8))) {
+                            from |= SQ_BB(sq - 8);
+                            if ((sq >> 3) == 3 && !(occ & SQ_BB(sq - 16))) from |= SQ_BB(sq - 16);
+                        }
+                    } else {
+                        from = piece_attacks(t->types[j], sq, occ) & ~occ;
+                    }
+                    while (from) {
+                        Squares prev = s;
+                        if (j < 0) prev.wk = bb_pop_lsb(&from);
+                        else prev.p[j] = bb_pop_lsb(&from);
+                        size_t pidx = encode(t, 0, &prev);
+                        if (dtm[pidx] != 0) continue;
+                        dtm[pidx] = (uint8_t)(level + 2);
+                        if (!list_push(&levels[level + 1], pidx)) goto fail;
+                    }
+                }
+            }
+        }
+        free(list->items);
+        list->items = NULL;
+    }
+
+    free(levels);
+    free(drawn);
+    t->dtm = dtm;
+    return true;
+
+fail:
+    fprintf(stderr, "Warning: out of memory building the %s endgame table.\n", t->name);
+    if (levels)
+        for (int level = 0; level < MAX_LEVELS; level++) free(levels[level].items);
+    free(levels);
+    free(drawn);
+    free(dtm);
+    return false;
+}
+
+// --- Disk cache ---
+
+static char cache_dir[512];
+static bool use_cache = false;
+
+static void cache_path(const Table *t, char *path, size_t size) {
+    snprintf(path, size, "%s/%s", cache_dir, t->file);
+}
+
+static bool load(Table *t) {
+    char path[600];
+    cache_path(t, path, sizeof(path));
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    char magic[8];
+    uint8_t *dtm = malloc(t->size);
+    bool ok = dtm && fread(magic, 1, sizeof(magic), f) == sizeof(magic) && memcmp(magic, FILE_MAGIC, sizeof(magic)) == 0 &&
+              fread(dtm, 1, t->size, f) == t->size && fgetc(f) == EOF;
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "Warning: %s is not a valid %s table, rebuilding it.\n", path, t->name);
+        free(dtm);
+        return false;
+    }
+    t->dtm = dtm;
+    return true;
+}
+
+// Written under a temporary name first, so a reader never sees half a table
+static void save(const Table *t) {
+    char path[600], tmp[610];
+    cache_path(t, path, sizeof(path));
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *f = fopen(tmp, "wb");
+    bool ok = f && fwrite(FILE_MAGIC, 1, 8, f) == 8 && fwrite(t->dtm, 1, t->size, f) == t->size;
+    if (f && fclose(f) != 0) ok = false;
+    if (!ok || rename(tmp, path) != 0) {
+        fprintf(stderr, "Warning: could not save the %s endgame table to %s.\n", t->name, path);
+        remove(tmp);
+    }
+}
+
+// --- Background builders ---
+
+// KPK promotes into KQK and KRK, so it follows them on the same thread;
+// KBNK, by far the largest, builds alongside.
+static const EgtbTable build_order[][4] = {
+    {EGTB_KQK, EGTB_KRK, EGTB_KPK, EGTB_TABLES},
+    {EGTB_KBNK, EGTB_TABLES},
+};
+#define BUILDERS (int)(sizeof(build_order) / sizeof(build_order[0]))
+
+static pthread_t builders[BUILDERS];
+static bool builder_running[BUILDERS];
+
+static void *builder_main(void *arg) {
+    const EgtbTable *order = arg;
+    for (; *order != EGTB_TABLES; order++) {
+        Table *t = &tables[*order];
+        if (!(use_cache && load(t))) {
+            if (!build(t)) continue;
+            if (use_cache) save(t);
+        }
+        __atomic_store_n(&t->ready, true, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+void egtb_init(const char *dir) {
+    for (int i = 0; i < BUILDERS; i++)
+        if (builder_running[i]) return;   // already started
+    struct stat st;
+    use_cache = dir && stat(dir, &st) == 0 && S_ISDIR(st.st_mode);
+    if (dir) snprintf(cache_dir, sizeof(cache_dir), "%s", dir);
+    for (int i = 0; i < EGTB_TABLES; i++) tables[i].size = table_size(&tables[i]);
+    for (int i = 0; i < BUILDERS; i++) {
+        if (pthread_create(&builders[i], NULL, builder_main, (void *)build_order[i]) == 0) {
+            builder_running[i] = true;
+        } else {
+            fprintf(stderr, "Warning: could not start an endgame table builder, building in place.\n");
+            builder_main((void *)build_order[i]);
+        }
+    }
+}
+
+void egtb_wait(void) {
+    for (int i = 0; i < BUILDERS; i++) {
+        if (!builder_running[i]) continue;
+        pthread_join(builders[i], NULL);
+        builder_running[i] = false;
+    }
+}
+
+void egtb_free(void) {
+    egtb_wait();
+    for (int i = 0; i < EGTB_TABLES; i++) {
+        __atomic_store_n(&tables[i].ready, false, __ATOMIC_RELEASE);
+        free(tables[i].dtm);
+        tables[i].dtm = NULL;
+    }
+}
+
+// --- Probing ---
+
+EgtbResult egtb_probe(const Position *pos, int *plies) {
+    int count = bb_count(pos->by_type[EMPTY]);
+    if (count < 3 || count > 4 || pos->castling) return EGTB_UNKNOWN;
+    int strong = bb_count(pos->by_color[0]) > 1 ? 1 : -1;
+    if (bb_count(pos->by_color[COLOR_IDX(-strong)]) != 1) return EGTB_UNKNOWN;
+
+    EgtbTable id;
+    if (count == 4) {
+        if (bb_count(pos->by_type[W_BISHOP]) != 1 || bb_count(pos->by_type[W_KNIGHT]) != 1) return EGTB_UNKNOWN;
+        id = EGTB_KBNK;
+    } else if (pos->by_type[W_PAWN]) {
+        id = EGTB_KPK;
+    } else if (pos->by_type[W_QUEEN]) {
+        id = EGTB_KQK;
+    } else if (pos->by_type[W_ROOK]) {
+        id = EGTB_KRK;
+    } else {
+        return EGTB_UNKNOWN;
+    }
+    const Table *t = &tables[id];
+    if (!is_ready(t)) return EGTB_UNKNOWN;
+
+    // Seen from the strong side, as White
+    int flip = strong > 0 ? 0 : 56;
+    Squares s;
+    s.wk = pos->king_sq[COLOR_IDX(strong)] ^ flip;
+    s.bk = pos->king_sq[COLOR_IDX(-strong)] ^ flip;
+    for (int i = 0; i < t->extra; i++) s.p[i] = bb_lsb(pos_pieces(pos, strong, t->types[i])) ^ flip;
+    int stm = pos->side == strong ? 0 : 1;
+
+    uint8_t v = t->dtm[encode(t, stm, &s)];
+    if (v == DTM_ILLEGAL) return EGTB_UNKNOWN;
+    if (v == 0) return EGTB_DRAW;
+    *plies = v - 1;
+    return stm == 0 ? EGTB_WIN : EGTB_LOSS;
+}
+
+void egtb_stats(EgtbTable table, EgtbStats *stats) {
+    const Table *t = &tables[table];
+    memset(stats, 0, sizeof(*stats));
+    stats->name = t->name;
+    stats->ready = is_ready(t);
+    if (!stats->ready) return;
+    size_t half = t->size / 2;
+    for (size_t idx = 0; idx < t->size; idx++) {
+        int stm = idx >= half;
+        uint8_t v = t->dtm[idx];
+        if (v == DTM_ILLEGAL) continue;
+        stats->positions[stm]++;
+        if (v == 0) continue;
+        stats->wins[stm]++;
+        if (v - 1 > stats->longest[stm]) stats->longest[stm] = v - 1;
+    }
+}
@@ -0,0 +1,10 @@
+#include "engine.h"
+#include "attacks.h"
+#include "position.h"
+#include "psqt.h"
+
+void engine_init(void) {
+    attacks_init();
+    zobrist_init();
+    psqt_init();
+}
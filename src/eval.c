@@ -0,0 +1,15 @@
+#include "eval.h"
+#include "nnue.h"
+
+// Side-to-move bonus, so scores don't swing between odd and even depths
+#define TEMPO 10
+
+int evaluate(const Position *pos) {
+    if (nnue_loaded()) return nnue_evaluate(pos);
+
+    // Taper between the middlegame and endgame halves of the incremental score
+    int phase = pos->phase < PHASE_MAX ? pos->phase : PHASE_MAX;
+    int mg = SCORE_MG(pos->psq), eg = SCORE_EG(pos->psq);
+    int score = (mg * phase + eg * (PHASE_MAX - phase)) / PHASE_MAX;
+    return score * pos->side + TEMPO;
+}
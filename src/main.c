@@ -1,18 +1,90 @@
 #include "raylib.h"
+#include "engine.h"
+#include "tt.h"
+#include "search.h"
+#include "ai.h"
+#include "book.h"
+#include "egtb.h"
+#include "nnue.h"
 #include "config.h"
 #include "db.h"
 #include "ui.h"
+#include "menu.h"
+#include "chess_logic.h"
+#include "models.h"
+#include <string.h>
+
+// The player's side, once per frame: click one of their pieces, then its
+// target square. Returns true once a move is played.
+static bool player_frame(int board[8][8], int player_color, Camera camera, int *sel_row, int *sel_col) {
+    int row, col;
+    if (current_game()->turn != player_color || current_status(board) != GAME_ONGOING ||
+        !IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || !pick_tile(camera, GetMousePosition(), &row, &col))
+        return false;
+    if (board[row][col] != EMPTY && (board[row][col] > 0) == (player_color > 0)) {
+        *sel_row = row;
+        *sel_col = col;
+        return false;
+    }
+    if (*sel_row < 0 || !is_valid_move(board, *sel_row, *sel_col, row, col)) return false;
+    apply_move(board, *sel_row, *sel_col, row, col);
+    *sel_row = *sel_col = -1;
+    return true;
+}
+
+// The AI's side of a game, once per frame: answer the player's move (going
+// on with the ponder search if it predicted it), play the move when the poll
+// hands it over, then ponder on the player's time
+static void ai_frame(int board[8][8], int ai_color, bool player_moved, UIOverlayInfo *overlay) {
+    SearchLimits limits;
+    ai_difficulty_limits(ai_difficulty, &limits);
+    Position pos;
+    SearchResult result;
+    if (player_moved && current_status(board) == GAME_ONGOING) {
+        current_position(board, &pos);
+        ai_opponent_moved(&pos, &current_game()->history, &limits);
+    }
+    switch (ai_poll_result(&result)) {
+    case AI_SEARCH_DONE: {
+        Move m = result.best_move;
+        apply_promotion(board, m.fr, m.fc, m.tr, m.tc, m.promo);
+        if (current_status(board) == GAME_ONGOING) {
+            current_position(board, &pos);
+            ai_start_ponder(&pos, &current_game()->history, &result, &limits);
+        }
+        break;
+    }
+    case AI_SEARCH_IDLE:
+        if (current_game()->turn == ai_color && current_status(board) == GAME_ONGOING) {
+            current_position(board, &pos);
+            ai_start_search(&pos, &current_game()->history, &limits);
+        }
+        break;
+    default:
+        break;
+    }
+    overlay->show_stats = ai_search_stats(&overlay->search_stats);
+}
 
 int main(void) {
     // --- At startup: ---
     if (!DirectoryExists("assets")) MakeDirectory("assets");
     if (!DirectoryExists("saves")) MakeDirectory("saves");
 
+    engine_init();
     config_load("config.json");
+    tt_resize(vortex_config.hash_mb > 0 ? (size_t)vortex_config.hash_mb : TT_DEFAULT_MB);
+    search_set_threads(vortex_config.threads);
+    book_open("assets/book.bin");
+    egtb_init("assets");
+    if (vortex_config.nnue) nnue_load(NNUE_DEFAULT_PATH);
+    ai_set_book_depth(vortex_config.book_depth);
+    ai_set_ponder(vortex_config.ponder);
     db_open("saves/vortexmate.db");
 
     InitWindow(1280, 720, "VortexMate");
     SetTargetFPS(60);
+    SetExitKey(KEY_NULL);   // Esc pauses a game; Quit in the main menu exits
 
     Texture2D logo = LoadTexture("assets/VortexMate.png");
     bool logo_loaded = (logo.id > 0);
@@ -20,9 +92,26 @@ int main(void) {
     // Menu / branding state
     float logo_alpha = 0.0f;
     bool in_menu = true;
+    MenuState menu_state = MENU_STATE_MAIN;
+    AIDifficulty difficulty = ai_difficulty;
+    bool quit = false;
+
+    // Game vs AI: the player takes White
+    int board[8][8];
+    const int ai_color = BLACK_TURN;
+    int sel_row = -1, sel_col = -1;
+    UIOverlayInfo overlay = {0};
+    Camera camera = {0};
+    camera.position = (Vector3){0.0f, 9.0f, 8.0f};     // behind White
+    camera.target = (Vector3){0.0f, 0.0f, 0.0f};
+    camera.up = (Vector3){0.0f, 1.0f, 0.0f};
+    camera.fovy = 45.0f;
+    camera.projection = CAMERA_PERSPECTIVE;
 
     // --- Main Game Loop ---
-    while (!WindowShouldClose()) {
+    while (!quit && !WindowShouldClose()) {
+        in_menu = (menu_state != MENU_STATE_INGAME && menu_state != MENU_STATE_PAUSE);
+
         // --- Menu/branding polish: ---
         if (in_menu && logo_alpha < 1.0f) logo_alpha += GetFrameTime() * 1.2f;
         if (!in_menu && logo_alpha > 0.0f) logo_alpha -= GetFrameTime() * 1.2f;
@@ -31,7 +120,7 @@ int main(void) {
         ClearBackground(RAYWHITE);
 
         if (logo_loaded) {
-            DrawTexture(logo, (GetScreenWidth() - logo.width) / 2, (GetScreenHeight() - logo.height) / 2, Fade(WHITE, logo_alpha)); // fade-in/fade-out
+            DrawTexture(logo, (GetScreenWidth() - logo.width) / 2, (GetScreenHeight() - logo.height) / 2, Fade((Color){255, 255, 255, 255}, logo_alpha)); // fade-in/fade-out
         }
 
         DrawText("VortexMate v1.0 © VortexGame",
@@ -47,11 +136,72 @@ int main(void) {
 
         // All overlays: DrawRectangle(x, y, w, h, (Color){0,0,0,160}) behind text for readability.
 
+        MenuAction action;
+        switch (menu_state) {
+        case MENU_STATE_MAIN:
+            action = menu_main_draw();
+            if (action == MENU_NEW_AI) menu_state = MENU_STATE_AI_DIFFICULTY;
+            else if (action == MENU_SAVED_GAMES) menu_state = MENU_STATE_SAVED_GAMES;
+            else if (action == MENU_QUIT) quit = true;
+            break;
+        case MENU_STATE_AI_DIFFICULTY:
+            action = menu_ai_difficulty_draw(&difficulty);
+            if (action == MENU_NEW_AI) {
+                set_ai_difficulty(difficulty);
+                Position start;
+                position_from_fen(&start, START_FEN);
+                position_to_board(&start, board);
+                current_turn = WHITE_TURN;
+                reset_move_state();
+                sel_row = sel_col = -1;
+                memset(&overlay, 0, sizeof(overlay));
+                menu_state = MENU_STATE_INGAME;
+            } else if (action == MENU_QUIT_TO_MAIN) {
+                menu_state = MENU_STATE_MAIN;
+            }
+            break;
+        case MENU_STATE_SAVED_GAMES:
+            if (menu_saved_games_draw() == MENU_QUIT_TO_MAIN) menu_state = MENU_STATE_MAIN;
+            break;
+        case MENU_STATE_INGAME: {
+            bool moved = player_frame(board, -ai_color, camera, &sel_row, &sel_col);
+            ai_frame(board, ai_color, moved, &overlay);
+            BeginMode3D(camera);
+            draw_board3d(board, camera, sel_row, sel_col);
+            EndMode3D();
+            draw_ui(&overlay, logo_alpha);
+            if (IsKeyPressed(KEY_ESCAPE)) menu_state = MENU_STATE_PAUSE;
+            break;
+        }
+        case MENU_STATE_PAUSE:
+            // The AI keeps thinking behind the menu; its move is played on resume
+            BeginMode3D(camera);
+            draw_board3d(board, camera, sel_row, sel_col);
+            EndMode3D();
+            draw_ui(&overlay, logo_alpha);
+            action = menu_pause_draw();
+            if (action == MENU_RESUME) {
+                menu_state = MENU_STATE_INGAME;
+            } else if (action == MENU_RESIGN || action == MENU_QUIT_TO_MAIN) {
+                ai_cancel();    // the game is over for the AI either way
+                menu_state = MENU_STATE_MAIN;
+            }
+            break;
+        default:
+            menu_state = MENU_STATE_MAIN;
+            break;
+        }
+
         EndDrawing();
     }
 
     // --- On exit: ---
     if (logo_loaded) UnloadTexture(logo);
+    ai_cancel();
+    tt_free();
+    book_close();
+    egtb_free();
+    nnue_unload();
     db_close();
     config_save("config.json");
     CloseWindow();
@@ -55,6 +55,19 @@ void draw_piece3d(int piece, int row, int col, Camera camera, float anim_scale,
     }
 }
 
+void draw_board3d(int board[8][8], Camera camera, int sel_row, int sel_col) {
+    const Color light = {200, 205, 220, 255}, dark = {70, 60, 100, 255};
+    for (int r = 0; r < 8; r++) {
+        for (int c = 0; c < 8; c++) {
+            Vector3 pos = board_to_world(r, c);
+            pos.y = -0.05f;
+            DrawCube(pos, 1.0f, 0.1f, 1.0f, ((r + c) % 2) ? dark : light);
+            if (r == sel_row && c == sel_col) DrawCubeWires(pos, 1.0f, 0.12f, 1.0f, WHITE_ACCENT);
+            draw_piece3d(board[r][c], r, c, camera, 1.0f, 1.0f);
+        }
+    }
+}
+
 // --- Piece string names utility ---
 const char* piece_name(int piece) {
     switch(piece) {
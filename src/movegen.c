@@ -0,0 +1,331 @@
+#include "movegen.h"
+#include "attacks.h"
+#include "nnue.h"
+
+// En passant removes two pieces from one line, so pin masks cannot cover it: test the king directly
+static bool en_passant_safe(const Position *pos, int from, int to) {
+    int us = pos->side, ksq = pos->king_sq[COLOR_IDX(us)];
+    if (ksq == SQ_NONE) return true;
+    int cap = to - 8 * us;
+    Bitboard occ = (pos->by_type[EMPTY] ^ SQ_BB(from) ^ SQ_BB(cap)) | SQ_BB(to);
+    Bitboard them = pos->by_color[COLOR_IDX(-us)] & ~SQ_BB(cap);
+    return !(attackers_to(pos, ksq, occ) & them);
+}
+
+// Own pieces that are the only blocker between the king and an enemy slider
+static Bitboard pinned_pieces(const Position *pos, int ksq, Bitboard own, Bitboard them) {
+    Bitboard pinned = 0, occ = pos->by_type[EMPTY];
+    Bitboard snipers = ((rook_attacks(ksq, 0) & (pos->by_type[W_ROOK] | pos->by_type[W_QUEEN]))
+                      | (bishop_attacks(ksq, 0) & (pos->by_type[W_BISHOP] | pos->by_type[W_QUEEN]))) & them;
+    while (snipers) {
+        Bitboard blockers = between_bb[ksq][bb_pop_lsb(&snipers)] & occ;
+        if (blockers && !(blockers & (blockers - 1)) && (blockers & own)) pinned |= blockers;
+    }
+    return pinned;
+}
+
+static int add_move(Move *moves, int count, int from, int to, int promo, int flags) {
+    moves[count].fr = (int8_t)SQ_ROW(from);
+    moves[count].fc = (int8_t)SQ_COL(from);
+    moves[count].tr = (int8_t)SQ_ROW(to);
+    moves[count].tc = (int8_t)SQ_COL(to);
+    moves[count].promo = (int8_t)promo;
+    moves[count].flags = (uint8_t)flags;
+    return count + 1;
+}
+
+static int add_pawn_moves(Move *moves, int count, int from, int to, int flags) {
+    int rank = to >> 3;
+    if (rank == 0 || rank == 7) {
+        count = add_move(moves, count, from, to, W_QUEEN, flags);
+        count = add_move(moves, count, from, to, W_ROOK, flags);
+        count = add_move(moves, count, from, to, W_BISHOP, flags);
+        return add_move(moves, count, from, to, W_KNIGHT, flags);
+    }
+    return add_move(moves, count, from, to, EMPTY, flags);
+}
+
+static int add_targets(Move *moves, int count, int from, Bitboard targets, Bitboard them) {
+    while (targets) {
+        int to = bb_pop_lsb(&targets);
+        count = add_move(moves, count, from, to, EMPTY, (them & SQ_BB(to)) ? MOVE_CAPTURE : 0);
+    }
+    return count;
+}
+
+// Legal moves only. Checkers, pins and the check-evasion mask are computed once, so no
+// move needs a king-safety test except king steps and en passant. With first_only the
+// generator returns as soon as one piece has produced a move; with captures_only it
+// emits just captures and promotions.
+static int generate_legal(const Position *pos, Move *moves, bool first_only, bool captures_only) {
+    int us = pos->side, count = 0;
+    Bitboard own = pos->by_color[COLOR_IDX(us)];
+    Bitboard them = pos->by_color[COLOR_IDX(-us)];
+    Bitboard occ = pos->by_type[EMPTY];
+    Bitboard checkers = 0, pinned = 0, b;
+    int ksq = pos->king_sq[COLOR_IDX(us)];
+
+    if (ksq != SQ_NONE) {
+        checkers = attackers_to(pos, ksq, occ) & them;
+        pinned = pinned_pieces(pos, ksq, own, them);
+
+        // King steps are checked with the king lifted, so it cannot hide behind itself
+        Bitboard targets = king_attacks[ksq] & (captures_only ? them : ~own);
+        Bitboard lifted = occ ^ SQ_BB(ksq);
+        while (targets) {
+            int to = bb_pop_lsb(&targets);
+            if (!(attackers_to(pos, to, lifted) & them))
+                count = add_move(moves, count, ksq, to, EMPTY, (them & SQ_BB(to)) ? MOVE_CAPTURE : 0);
+        }
+        if (first_only && count) return count;
+        if (checkers & (checkers - 1)) return count; // double check: king moves only
+    }
+
+    // Other pieces must capture the checker or block the check
+    Bitboard evasion = checkers ? (checkers | between_bb[ksq][bb_lsb(checkers)]) : ~own;
+    Bitboard targets = captures_only ? (evasion & them) : evasion;
+
+    // Pawns: pushes, double pushes, captures, promotions, en passant
+    int push = 8 * us;
+    int start_rank = (us > 0) ? 1 : 6;
+    b = pos_pieces(pos, us, W_PAWN);
+    while (b) {
+        int from = bb_pop_lsb(&b);
+        Bitboard allowed = (pinned & SQ_BB(from)) ? (evasion & line_bb[ksq][from]) : evasion;
+        int to = from + push;
+        if (!(occ & SQ_BB(to)) && (!captures_only || (to >> 3) == 0 || (to >> 3) == 7)) {
+            if (allowed & SQ_BB(to)) count = add_pawn_moves(moves, count, from, to, 0);
+            if (!captures_only && (from >> 3) == start_rank && !(occ & SQ_BB(to + push)) && (allowed & SQ_BB(to + push)))
+                count = add_move(moves, count, from, to + push, EMPTY, MOVE_DOUBLE_PUSH);
+        }
+        Bitboard caps = pawn_attacks[COLOR_IDX(us)][from] & them & allowed;
+        while (caps) count = add_pawn_moves(moves, count, from, bb_pop_lsb(&caps), MOVE_CAPTURE);
+        if (first_only && count) return count;
+    }
+    if (pos->ep_square != SQ_NONE && (pos->ep_square >> 3) == ((us > 0) ? 5 : 2)
+        && !(occ & SQ_BB(pos->ep_square))
+        && (pos_pieces(pos, -us, W_PAWN) & SQ_BB(pos->ep_square - push))) {
+        Bitboard capturers = pawn_attacks[COLOR_IDX(-us)][pos->ep_square] & pos_pieces(pos, us, W_PAWN);
+        while (capturers) {
+            int from = bb_pop_lsb(&capturers);
+            if (en_passant_safe(pos, from, pos->ep_square))
+                count = add_move(moves, count, from, pos->ep_square, EMPTY, MOVE_CAPTURE | MOVE_EN_PASSANT);
+        }
+        if (first_only && count) return count;
+    }
+
+    // A pinned knight can never stay on its pin line
+    b = pos_pieces(pos, us, W_KNIGHT) & ~pinned;
+    while (b) {
+        int from = bb_pop_lsb(&b);
+        count = add_targets(moves, count, from, knight_attacks[from] & targets, them);
+        if (first_only && count) return count;
+    }
+    b = pos_pieces(pos, us, W_BISHOP) | pos_pieces(pos, us, W_QUEEN);
+    while (b) {
+        int from = bb_pop_lsb(&b);
+        Bitboard allowed = (pinned & SQ_BB(from)) ? (targets & line_bb[ksq][from]) : targets;
+        count = add_targets(moves, count, from, bishop_attacks(from, occ) & allowed, them);
+        if (first_only && count) return count;
+    }
+    b = pos_pieces(pos, us, W_ROOK) | pos_pieces(pos, us, W_QUEEN);
+    while (b) {
+        int from = bb_pop_lsb(&b);
+        Bitboard allowed = (pinned & SQ_BB(from)) ? (targets & line_bb[ksq][from]) : targets;
+        count = add_targets(moves, count, from, rook_attacks(from, occ) & allowed, them);
+        if (first_only && count) return count;
+    }
+
+    // Castling: squares between king and rook empty, king not in, through or into check
+    int kside = (us > 0) ? CASTLE_WK : CASTLE_BK;
+    int qside = (us > 0) ? CASTLE_WQ : CASTLE_BQ;
+    int home = (us > 0) ? 4 : 60;
+    if (!captures_only && ksq == home && !checkers && (pos->castling & (kside | qside))) {
+        if ((pos->castling & kside) && !(occ & (SQ_BB(home + 1) | SQ_BB(home + 2)))
+            && !square_attacked(pos, home + 1, -us) && !square_attacked(pos, home + 2, -us))
+            count = add_move(moves, count, home, home + 2, EMPTY, MOVE_CASTLE);
+        if ((pos->castling & qside) && !(occ & (SQ_BB(home - 1) | SQ_BB(home - 2) | SQ_BB(home - 3)))
+            && !square_attacked(pos, home - 1, -us) && !square_attacked(pos, home - 2, -us))
+            count = add_move(moves, count, home, home - 2, EMPTY, MOVE_CASTLE);
+    }
+    return count;
+}
+
+int generate_moves(const Position *pos, Move moves[MAX_MOVES]) {
+    return generate_legal(pos, moves, false, false);
+}
+
+int generate_captures(const Position *pos, Move moves[MAX_MOVES]) {
+    return generate_legal(pos, moves, false, true);
+}
+
+bool has_legal_moves(const Position *pos) {
+    Move moves[MAX_MOVES];
+    return generate_legal(pos, moves, true, false) > 0;
+}
+
+void move_to_uci(Move m, char *buf) {
+    static const char promo_chars[] = " prnbqk";
+    buf[0] = (char)('a' + m.fc);
+    buf[1] = (char)('1' + (7 - m.fr));
+    buf[2] = (char)('a' + m.tc);
+    buf[3] = (char)('1' + (7 - m.tr));
+    buf[4] = (m.promo != EMPTY) ? promo_chars[m.promo] : '\0';
+    buf[5] = '\0';
+}
+
+// --- Make / unmake ---
+
+// Rights lost when a move touches the square (king or rook leaving or being captured)
+static const uint8_t castle_lost[64] = {
+    [0] = CASTLE_WQ, [4] = CASTLE_WK | CASTLE_WQ, [7] = CASTLE_WK,
+    [56] = CASTLE_BQ, [60] = CASTLE_BK | CASTLE_BQ, [63] = CASTLE_BK
+};
+
+static inline void toggle_piece(Position *pos, int type, int color, Bitboard bits) {
+    pos->by_type[type] ^= bits;
+    pos->by_type[EMPTY] ^= bits;
+    pos->by_color[COLOR_IDX(color)] ^= bits;
+}
+
+static inline int piece_type_on(const Position *pos, int sq) {
+    int piece = pos_piece_on(pos, sq);
+    return (piece > 0) ? piece : -piece;
+}
+
+void make_move(Position *pos, Move m, Undo *undo) {
+    int us = pos->side, from = MOVE_FROM(m), to = MOVE_TO(m);
+    int type = piece_type_on(pos, from);
+
+    undo->captured = EMPTY;
+    undo->castling = pos->castling;
+    undo->ep_square = pos->ep_square;
+    undo->halfmove = pos->halfmove;
+    undo->key = pos->key;
+    undo->psq = pos->psq;
+    undo->phase = pos->phase;
+
+    int ui = COLOR_IDX(us), ti = COLOR_IDX(-us);
+    uint64_t key = pos->key ^ zobrist_side;
+    Score psq = pos->psq;
+
+    if (m.flags & MOVE_EN_PASSANT) {
+        undo->captured = (int8_t)(-us * W_PAWN);
+        toggle_piece(pos, W_PAWN, -us, SQ_BB(to - 8 * us));
+        key ^= zobrist_piece[ti][W_PAWN][to - 8 * us];
+        psq -= psqt[ti][W_PAWN][to - 8 * us];
+    } else if (m.flags & MOVE_CAPTURE) {
+        int cap_type = piece_type_on(pos, to);
+        undo->captured = (int8_t)(-us * cap_type);
+        toggle_piece(pos, cap_type, -us, SQ_BB(to));
+        key ^= zobrist_piece[ti][cap_type][to];
+        psq -= psqt[ti][cap_type][to];
+        pos->phase = (uint8_t)(pos->phase - phase_weight[cap_type]);
+    }
+
+    toggle_piece(pos, type, us, SQ_BB(from) | SQ_BB(to));
+    key ^= zobrist_piece[ui][type][from];
+    psq -= psqt[ui][type][from];
+    if (m.promo != EMPTY) {
+        pos->by_type[W_PAWN] ^= SQ_BB(to);
+        pos->by_type[m.promo] ^= SQ_BB(to);
+        key ^= zobrist_piece[ui][m.promo][to];
+        psq += psqt[ui][m.promo][to];
+        pos->phase = (uint8_t)(pos->phase + phase_weight[m.promo]);
+    } else {
+        key ^= zobrist_piece[ui][type][to];
+        psq += psqt[ui][type][to];
+    }
+    if (type == W_KING) {
+        pos->king_sq[ui] = (int8_t)to;
+        if (m.flags & MOVE_CASTLE) {
+            int rook_from = (to > from) ? from + 3 : from - 4;
+            int rook_to = (to > from) ? from + 1 : from - 1;
+            toggle_piece(pos, W_ROOK, us, SQ_BB(rook_from) | SQ_BB(rook_to));
+            key ^= zobrist_piece[ui][W_ROOK][rook_from] ^ zobrist_piece[ui][W_ROOK][rook_to];
+            psq += psqt[ui][W_ROOK][rook_to] - psqt[ui][W_ROOK][rook_from];
+        }
+    }
+    pos->psq = psq;
+
+    key ^= zobrist_castling[pos->castling];
+    pos->castling &= (uint8_t)~(castle_lost[from] | castle_lost[to]);
+    key ^= zobrist_castling[pos->castling];
+
+    if (pos->ep_square != SQ_NONE) key ^= zobrist_ep[pos->ep_square & 7];
+    pos->ep_square = SQ_NONE;
+    if (m.flags & MOVE_DOUBLE_PUSH) {
+        // Only record the target when an enemy pawn can actually capture there
+        int skipped = from + 8 * us;
+        if (pawn_attacks[ui][skipped] & pos_pieces(pos, -us, W_PAWN)) {
+            pos->ep_square = (int8_t)skipped;
+            key ^= zobrist_ep[skipped & 7];
+        }
+    }
+    pos->key = key;
+    pos->halfmove = (type == W_PAWN || undo->captured != EMPTY) ? 0 : (uint8_t)(pos->halfmove + 1);
+    if (us < 0) pos->fullmove++;
+    pos->side = (int8_t)-us;
+    if (nnue_tracked == pos) nnue_push_move(pos, m, type, undo->captured);
+}
+
+void unmake_move(Position *pos, Move m, const Undo *undo) {
+    int us = -pos->side, from = MOVE_FROM(m), to = MOVE_TO(m);
+    pos->side = (int8_t)us;
+    if (us < 0) pos->fullmove--;
+
+    if (m.promo != EMPTY) {
+        pos->by_type[m.promo] ^= SQ_BB(to);
+        pos->by_type[W_PAWN] ^= SQ_BB(to);
+    }
+    int type = piece_type_on(pos, to);
+    toggle_piece(pos, type, us, SQ_BB(from) | SQ_BB(to));
+    if (type == W_KING) {
+        pos->king_sq[COLOR_IDX(us)] = (int8_t)from;
+        if (m.flags & MOVE_CASTLE) {
+            int rook_from = (to > from) ? from + 3 : from - 4;
+            int rook_to = (to > from) ? from + 1 : from - 1;
+            toggle_piece(pos, W_ROOK, us, SQ_BB(rook_from) | SQ_BB(rook_to));
+        }
+    }
+
+    if (undo->captured != EMPTY) {
+        int cap_sq = (m.flags & MOVE_EN_PASSANT) ? to - 8 * us : to;
+        int cap_type = (undo->captured > 0) ? undo->captured : -undo->captured;
+        toggle_piece(pos, cap_type, -us, SQ_BB(cap_sq));
+    }
+
+    pos->castling = undo->castling;
+    pos->ep_square = undo->ep_square;
+    pos->halfmove = undo->halfmove;
+    pos->key = undo->key;
+    pos->psq = undo->psq;
+    pos->phase = undo->phase;
+    if (nnue_tracked == pos) nnue_pop();
+}
+
+void make_null_move(Position *pos, Undo *undo) {
+    undo->captured = EMPTY;
+    undo->castling = pos->castling;
+    undo->ep_square = pos->ep_square;
+    undo->halfmove = pos->halfmove;
+    undo->key = pos->key;
+    undo->psq = pos->psq;
+    undo->phase = pos->phase;
+
+    uint64_t key = pos->key ^ zobrist_side;
+    if (pos->ep_square != SQ_NONE) key ^= zobrist_ep[pos->ep_square & 7];
+    pos->ep_square = SQ_NONE;
+    pos->key = key;
+    pos->halfmove = 0;
+    pos->side = (int8_t)-pos->side;
+    if (nnue_tracked == pos) nnue_push_null();
+}
+
+void unmake_null_move(Position *pos, const Undo *undo) {
+    pos->side = (int8_t)-pos->side;
+    pos->ep_square = undo->ep_square;
+    pos->halfmove = undo->halfmove;
+    pos->key = undo->key;
+    if (nnue_tracked == pos) nnue_pop();
+}
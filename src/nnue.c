@@ -0,0 +1,462 @@
+#include "nnue.h"
+#include "search.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NNUE_X86 1
+#endif
+
+// Accumulators kept per thread: the root plus one per ply, with room for the
+// null moves and quiescence plies on the deepest path
+#define NNUE_STACK (MAX_PLY + 8)
+
+// Scores stay far from the mate range whatever the network says
+#define NNUE_EVAL_LIMIT 10000
+
+typedef struct {
+    const int16_t *ft_bias;       // [L1]
+    const int16_t *ft_weights;    // [FEATURES][L1]
+    const int32_t *ft_psqt;       // [FEATURES]
+    const int32_t *l1_bias;       // [L2]
+    const int8_t *l1_weights;     // [L2][2 * L1]
+    const int32_t *l2_bias;       // [L3]
+    const int8_t *l2_weights;     // [L3][L2]
+    const int32_t *out_bias;      // [1]
+    const int8_t *out_weights;    // [L3]
+} Network;
+
+static Network net;
+static void *net_data = NULL;
+static size_t net_size = 0;
+
+// A piece that left from and/or arrived on a square (SQ_NONE for neither)
+typedef struct {
+    int8_t piece, from, to;
+} DirtyPiece;
+
+typedef struct {
+    int16_t acc[2][NNUE_L1] __attribute__((aligned(32)));   // [COLOR_IDX(perspective)]
+    int32_t psqt[2];
+    bool computed[2];
+    bool king_moved[2];     // the move into this entry moved that side's king
+    int dirty_count;
+    DirtyPiece dirty[3];    // changes from the entry below
+} Accumulator;
+
+typedef struct {
+    const Position *pos;
+    int depth;              // current entry; beyond NNUE_STACK - 1 evaluations refresh
+    Accumulator stack[NNUE_STACK];
+} NnueContext;
+
+__thread const Position *nnue_tracked = NULL;
+static __thread NnueContext *context = NULL;
+
+// Each thread keeps its accumulators from one search to the next; this key
+// frees them when the thread exits (the search starts new helpers every move)
+static pthread_key_t context_key;
+static bool context_key_ok;
+static pthread_once_t context_key_once = PTHREAD_ONCE_INIT;
+
+static void context_key_init(void) {
+    context_key_ok = pthread_key_create(&context_key, free) == 0;
+    if (!context_key_ok) fprintf(stderr, "Warning: NNUE accumulators of finished threads will not be freed.\n");
+}
+
+// --- Kernels ---
+
+typedef struct {
+    const char *name;
+    bool (*supported)(void);
+    void (*add)(int16_t *acc, const int16_t *row);
+    void (*sub)(int16_t *acc, const int16_t *row);
+    void (*clip)(uint8_t *out, const int16_t *in);                  // NNUE_L1 values to [0, 127]
+    int32_t (*dot)(const uint8_t *in, const int8_t *w, int n);     // n a multiple of 32
+} Kernel;
+
+static bool scalar_supported(void) { return true; }
+
+static void scalar_add(int16_t *acc, const int16_t *row) {
+    for (int i = 0; i < NNUE_L1; i++) acc[i] = (int16_t)(acc[i] + row[i]);
+}
+
+static void scalar_sub(int16_t *acc, const int16_t *row) {
+    for (int i = 0; i < NNUE_L1; i++) acc[i] = (int16_t)(acc[i] - row[i]);
+}
+
+static void scalar_clip(uint8_t *out, const int16_t *in) {
+    for (int i = 0; i < NNUE_L1; i++) out[i] = (uint8_t)(in[i] < 0 ? 0 : in[i] > 127 ? 127 : in[i]);
+}
+
+static int32_t scalar_dot(const uint8_t *in, const int8_t *w, int n) {
+    int32_t sum = 0;
+    for (int i = 0; i < n; i++) sum += (int32_t)in[i] * w[i];
+    return sum;
+}
+
+#ifdef NNUE_X86
+// Inputs are at most 127, so the pairwise products of maddubs (at most
+// 2 * 127 * 128) never saturate and every kernel matches the scalar one exactly.
+
+static bool sse41_supported(void) { return __builtin_cpu_supports("sse4.1"); }
+
+__attribute__((target("sse4.1")))
+static void sse41_add(int16_t *acc, const int16_t *row) {
+    for (int i = 0; i < NNUE_L1; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(acc + i));
+        __m128i r = _mm_loadu_si128((const __m128i *)(row + i));
+        _mm_storeu_si128((__m128i *)(acc + i), _mm_add_epi16(a, r));
+    }
+}
+
+__attribute__((target("sse4.1")))
+static void sse41_sub(int16_t *acc, const int16_t *row) {
+    for (int i = 0; i < NNUE_L1; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(acc + i));
+        __m128i r = _mm_loadu_si128((const __m128i *)(row + i));
+        _mm_storeu_si128((__m128i *)(acc + i), _mm_sub_epi16(a, r));
+    }
+}
+
+__attribute__((target("sse4.1")))
+static void sse41_clip(uint8_t *out, const int16_t *in) {
+    const __m128i max = _mm_set1_epi8(127);
+    for (int i = 0; i < NNUE_L1; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(in + i + 8));
+        _mm_storeu_si128((__m128i *)(out + i), _mm_min_epu8(_mm_packus_epi16(a, b), max));
+    }
+}
+
+__attribute__((target("sse4.1")))
+static int32_t sse41_dot(const uint8_t *in, const int8_t *w, int n) {
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(w + i));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(a, b), ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+static bool avx2_supported(void) { return __builtin_cpu_supports("avx2"); }
+
+__attribute__((target("avx2")))
+static void avx2_add(int16_t *acc, const int16_t *row) {
+    for (int i = 0; i < NNUE_L1; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(acc + i));
+        __m256i r = _mm256_loadu_si256((const __m256i *)(row + i));
+        _mm256_storeu_si256((__m256i *)(acc + i), _mm256_add_epi16(a, r));
+    }
+}
+
+__attribute__((target("avx2")))
+static void avx2_sub(int16_t *acc, const int16_t *row) {
+    for (int i = 0; i < NNUE_L1; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(acc + i));
+        __m256i r = _mm256_loadu_si256((const __m256i *)(row + i));
+        _mm256_storeu_si256((__m256i *)(acc + i), _mm256_sub_epi16(a, r));
+    }
+}
+
+__attribute__((target("avx2")))
+static void avx2_clip(uint8_t *out, const int16_t *in) {
+    const __m256i max = _mm256_set1_epi8(127);
+    for (int i = 0; i < NNUE_L1; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(in + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(in + i + 16));
+        // packus works per 128-bit lane; restore the order across lanes
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_min_epu8(packed, max));
+    }
+}
+
+__attribute__((target("avx2")))
+static int32_t avx2_dot(const uint8_t *in, const int8_t *w, int n) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < n; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(in + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(w + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(a, b), ones));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+}
+#endif
+
+// Best first
+static const Kernel kernels[] = {
+#ifdef NNUE_X86
+    {"avx2", avx2_supported, avx2_add, avx2_sub, avx2_clip, avx2_dot},
+    {"sse4.1", sse41_supported, sse41_add, sse41_sub, sse41_clip, sse41_dot},
+#endif
+    {"scalar", scalar_supported, scalar_add, scalar_sub, scalar_clip, scalar_dot},
+};
+#define KERNEL_COUNT (int)(sizeof(kernels) / sizeof(kernels[0]))
+
+static const Kernel *kernel = &kernels[KERNEL_COUNT - 1];
+
+static void select_kernel(void) {
+#ifdef NNUE_X86
+    __builtin_cpu_init();
+#endif
+    for (int i = 0; i < KERNEL_COUNT; i++) {
+        if (kernels[i].supported()) {
+            kernel = &kernels[i];
+            return;
+        }
+    }
+}
+
+const char *nnue_kernel(void) {
+    return kernel->name;
+}
+
+bool nnue_set_kernel(const char *name) {
+#ifdef NNUE_X86
+    __builtin_cpu_init();
+#endif
+    for (int i = 0; i < KERNEL_COUNT; i++) {
+        if (strcmp(kernels[i].name, name) == 0 && kernels[i].supported()) {
+            kernel = &kernels[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+// --- Loading ---
+
+static uint32_t read_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// Point net at the sections of a mapped file; the layout is fixed by the dimensions
+static size_t network_layout(const uint8_t *base, Network *n) {
+    size_t offset = NNUE_HEADER_SIZE;
+#define SECTION(field, type, count) \
+    n->field = (const type *)(base + offset); \
+    offset += sizeof(type) * (size_t)(count)
+    SECTION(ft_bias, int16_t, NNUE_L1);
+    SECTION(ft_weights, int16_t, (size_t)NNUE_FEATURES * NNUE_L1);
+    SECTION(ft_psqt, int32_t, NNUE_FEATURES);
+    SECTION(l1_bias, int32_t, NNUE_L2);
+    SECTION(l1_weights, int8_t, NNUE_L2 * 2 * NNUE_L1);
+    SECTION(l2_bias, int32_t, NNUE_L3);
+    SECTION(l2_weights, int8_t, NNUE_L3 * NNUE_L2);
+    SECTION(out_bias, int32_t, 1);
+    SECTION(out_weights, int8_t, NNUE_L3);
+#undef SECTION
+    return offset;
+}
+
+bool nnue_load(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    Network layout;
+    size_t expected = network_layout(NULL, &layout);
+    uint8_t header[NNUE_HEADER_SIZE];
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size != expected ||
+        read(fd, header, sizeof(header)) != (ssize_t)sizeof(header) ||
+        memcmp(header, NNUE_MAGIC, 8) != 0 || read_le32(header + 8) != NNUE_FEATURES ||
+        read_le32(header + 12) != NNUE_L1 || read_le32(header + 16) != NNUE_L2 ||
+        read_le32(header + 20) != NNUE_L3) {
+        fprintf(stderr, "Warning: %s is not a network for this engine, ignoring it.\n", path);
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, expected, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "Warning: could not map network %s.\n", path);
+        return false;
+    }
+    nnue_unload();
+    net_data = data;
+    net_size = expected;
+    network_layout(data, &net);
+    select_kernel();
+    return true;
+}
+
+void nnue_unload(void) {
+    if (net_data) munmap(net_data, net_size);
+    net_data = NULL;
+    net_size = 0;
+}
+
+bool nnue_loaded(void) {
+    return net_data != NULL;
+}
+
+// --- Accumulators ---
+
+static void refresh(const Position *pos, int16_t *acc, int32_t *psqt, int perspective) {
+    int king_sq = pos->king_sq[COLOR_IDX(perspective)];
+    memcpy(acc, net.ft_bias, sizeof(int16_t) * NNUE_L1);
+    *psqt = 0;
+    if (king_sq == SQ_NONE) return;
+    Bitboard pieces = pos->by_type[EMPTY] & ~pos->by_type[W_KING];
+    while (pieces) {
+        int sq = bb_pop_lsb(&pieces);
+        int f = nnue_feature(perspective, king_sq, pos_piece_on(pos, sq), sq);
+        kernel->add(acc, net.ft_weights + (size_t)f * NNUE_L1);
+        *psqt += net.ft_psqt[f];
+    }
+}
+
+// Apply the dirty pieces of entry e to the accumulator below it
+static void update(Accumulator *e, const Accumulator *prev, int pi, int perspective, int king_sq) {
+    memcpy(e->acc[pi], prev->acc[pi], sizeof(e->acc[pi]));
+    int32_t psqt = prev->psqt[pi];
+    for (int i = 0; i < e->dirty_count; i++) {
+        const DirtyPiece *d = &e->dirty[i];
+        if (d->from != SQ_NONE) {
+            int f = nnue_feature(perspective, king_sq, d->piece, d->from);
+            kernel->sub(e->acc[pi], net.ft_weights + (size_t)f * NNUE_L1);
+            psqt -= net.ft_psqt[f];
+        }
+        if (d->to != SQ_NONE) {
+            int f = nnue_feature(perspective, king_sq, d->piece, d->to);
+            kernel->add(e->acc[pi], net.ft_weights + (size_t)f * NNUE_L1);
+            psqt += net.ft_psqt[f];
+        }
+    }
+    e->psqt[pi] = psqt;
+    e->computed[pi] = true;
+}
+
+// Bring the top entry up to date for one side: replay the moves since the
+// last computed entry, unless that side's king moved in between
+static void update_perspective(NnueContext *ctx, const Position *pos, int perspective) {
+    int pi = COLOR_IDX(perspective);
+    Accumulator *top = &ctx->stack[ctx->depth];
+    if (top->computed[pi]) return;
+    int k = ctx->depth;
+    while (k > 0 && !ctx->stack[k].king_moved[pi] && !ctx->stack[k - 1].computed[pi]) k--;
+    if (k == 0 || ctx->stack[k].king_moved[pi]) {
+        refresh(pos, top->acc[pi], &top->psqt[pi], perspective);
+        top->computed[pi] = true;
+        return;
+    }
+    int king_sq = pos->king_sq[pi];
+    for (; k <= ctx->depth; k++) update(&ctx->stack[k], &ctx->stack[k - 1], pi, perspective, king_sq);
+}
+
+void nnue_attach(const Position *pos) {
+    nnue_detach();
+    if (!net_data) return;
+    if (!context) {
+        context = malloc(sizeof(NnueContext));
+        if (!context) {
+            fprintf(stderr, "Warning: could not allocate NNUE accumulators, evaluating from scratch.\n");
+            return;
+        }
+        pthread_once(&context_key_once, context_key_init);
+        if (context_key_ok) pthread_setspecific(context_key, context);
+    }
+    context->pos = pos;
+    context->depth = 0;
+    context->stack[0].computed[0] = context->stack[0].computed[1] = false;
+    context->stack[0].king_moved[0] = context->stack[0].king_moved[1] = false;
+    nnue_tracked = pos;
+}
+
+void nnue_detach(void) {
+    nnue_tracked = NULL;
+    if (context) context->pos = NULL;
+}
+
+static Accumulator *push_entry(void) {
+    if (++context->depth >= NNUE_STACK) return NULL;
+    Accumulator *e = &context->stack[context->depth];
+    e->computed[0] = e->computed[1] = false;
+    e->king_moved[0] = e->king_moved[1] = false;
+    e->dirty_count = 0;
+    return e;
+}
+
+void nnue_push_move(const Position *pos, Move m, int moved_type, int captured) {
+    Accumulator *e = push_entry();
+    if (!e) return;
+    int us = -pos->side, from = MOVE_FROM(m), to = MOVE_TO(m);
+    if (moved_type == W_KING) {
+        e->king_moved[COLOR_IDX(us)] = true;
+        if (m.flags & MOVE_CASTLE) {
+            int rook_from = (to > from) ? from + 3 : from - 4;
+            int rook_to = (to > from) ? from + 1 : from - 1;
+            e->dirty[e->dirty_count++] = (DirtyPiece){(int8_t)(us * W_ROOK), (int8_t)rook_from, (int8_t)rook_to};
+        }
+    } else if (m.promo != EMPTY) {
+        e->dirty[e->dirty_count++] = (DirtyPiece){(int8_t)(us * W_PAWN), (int8_t)from, SQ_NONE};
+        e->dirty[e->dirty_count++] = (DirtyPiece){(int8_t)(us * m.promo), SQ_NONE, (int8_t)to};
+    } else {
+        e->dirty[e->dirty_count++] = (DirtyPiece){(int8_t)(us * moved_type), (int8_t)from, (int8_t)to};
+    }
+    if (captured != EMPTY) {
+        int cap_sq = (m.flags & MOVE_EN_PASSANT) ? to - 8 * us : to;
+        e->dirty[e->dirty_count++] = (DirtyPiece){(int8_t)captured, (int8_t)cap_sq, SQ_NONE};
+    }
+}
+
+void nnue_push_null(void) {
+    push_entry();
+}
+
+void nnue_pop(void) {
+    context->depth--;
+}
+
+// --- Inference ---
+
+static int clip_hidden(int32_t x) {
+    x >>= NNUE_WEIGHT_SHIFT;
+    return x < 0 ? 0 : x > 127 ? 127 : x;
+}
+
+static int propagate(const int16_t (*acc)[NNUE_L1], const int32_t *psqt, int side) {
+    uint8_t input[2 * NNUE_L1] __attribute__((aligned(32)));
+    uint8_t h1[NNUE_L2] __attribute__((aligned(32)));
+    uint8_t h2[NNUE_L3] __attribute__((aligned(32)));
+    int us = COLOR_IDX(side), them = !us;
+
+    kernel->clip(input, acc[us]);
+    kernel->clip(input + NNUE_L1, acc[them]);
+    for (int o = 0; o < NNUE_L2; o++)
+        h1[o] = (uint8_t)clip_hidden(net.l1_bias[o] + kernel->dot(input, net.l1_weights + o * 2 * NNUE_L1, 2 * NNUE_L1));
+    for (int o = 0; o < NNUE_L3; o++)
+        h2[o] = (uint8_t)clip_hidden(net.l2_bias[o] + kernel->dot(h1, net.l2_weights + o * NNUE_L2, NNUE_L2));
+    int32_t out = net.out_bias[0] + kernel->dot(h2, net.out_weights, NNUE_L3);
+
+    int score = (out + (psqt[us] - psqt[them]) / 2) / NNUE_OUTPUT_SCALE;
+    return score < -NNUE_EVAL_LIMIT ? -NNUE_EVAL_LIMIT : score > NNUE_EVAL_LIMIT ? NNUE_EVAL_LIMIT : score;
+}
+
+int nnue_evaluate(const Position *pos) {
+    NnueContext *ctx = context;
+    if (ctx && ctx->pos == pos && ctx->depth < NNUE_STACK) {
+        update_perspective(ctx, pos, 1);
+        update_perspective(ctx, pos, -1);
+        Accumulator *top = &ctx->stack[ctx->depth];
+        return propagate((const int16_t (*)[NNUE_L1])top->acc, top->psqt, pos->side);
+    }
+    int16_t acc[2][NNUE_L1] __attribute__((aligned(32)));
+    int32_t psqt[2];
+    refresh(pos, acc[0], &psqt[0], 1);
+    refresh(pos, acc[1], &psqt[1], -1);
+    return propagate((const int16_t (*)[NNUE_L1])acc, psqt, pos->side);
+}
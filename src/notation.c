@@ -0,0 +1,158 @@
+#include "notation.h"
+#include "attacks.h"
+#include <string.h>
+#include <ctype.h>
+
+// Piece letters indexed by type; pawns have none in SAN
+static const char san_letters[] = "  RNBQK";
+
+static int type_from_letter(char c) {
+    switch (toupper((unsigned char)c)) {
+        case 'R': return W_ROOK;
+        case 'N': return W_KNIGHT;
+        case 'B': return W_BISHOP;
+        case 'Q': return W_QUEEN;
+        case 'K': return W_KING;
+        default:  return EMPTY;
+    }
+}
+
+bool move_from_uci(const Position *pos, const char *str, Move *out) {
+    Move moves[MAX_MOVES];
+    int count = generate_moves(pos, moves);
+    char buf[6];
+    for (int i = 0; i < count; i++) {
+        move_to_uci(moves[i], buf);
+        if (strcmp(buf, str) == 0) {
+            *out = moves[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool move_from_san(const Position *pos, const char *str, Move *out) {
+    char san[16];
+    size_t len = strlen(str);
+    if (len == 0 || len >= sizeof(san)) return false;
+    memcpy(san, str, len + 1);
+    while (len > 0 && strchr("+#!?", san[len - 1])) san[--len] = '\0';
+    if (len < 2) return false;
+
+    Move moves[MAX_MOVES];
+    int count = generate_moves(pos, moves);
+
+    // Castling: "O-O" / "O-O-O", also written with zeros
+    if (san[0] == 'O' || san[0] == '0') {
+        int to_col;
+        if (strcmp(san, "O-O") == 0 || strcmp(san, "0-0") == 0) to_col = 6;
+        else if (strcmp(san, "O-O-O") == 0 || strcmp(san, "0-0-0") == 0) to_col = 2;
+        else return false;
+        for (int i = 0; i < count; i++) {
+            if ((moves[i].flags & MOVE_CASTLE) && moves[i].tc == to_col) {
+                *out = moves[i];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int type = W_PAWN;
+    const char *p = san;
+    if (isupper((unsigned char)*p)) {
+        type = type_from_letter(*p);
+        if (type == EMPTY) return false;
+        p++;
+    }
+
+    // Promotion: "e8=Q", or "e8Q" without the sign
+    int promo = EMPTY;
+    char *eq = strchr(san, '=');
+    if (eq) {
+        promo = type_from_letter(eq[1]);
+        if (promo == EMPTY || promo == W_KING) return false;
+        *eq = '\0';
+        len = (size_t)(eq - san);
+    } else if (type == W_PAWN && type_from_letter(san[len - 1]) != EMPTY) {
+        promo = type_from_letter(san[len - 1]);
+        san[--len] = '\0';
+    }
+
+    // Destination is the last two characters; anything before it (apart from
+    // the capture mark) disambiguates the origin
+    if (len < 2 || (size_t)(p - san) > len - 2) return false;
+    char file = san[len - 2], rank = san[len - 1];
+    if (file < 'a' || file > 'h' || rank < '1' || rank > '8') return false;
+    int to = (rank - '1') * 8 + (file - 'a');
+    int from_file = -1, from_rank = -1;
+    for (const char *d = p; d < san + len - 2; d++) {
+        if (*d >= 'a' && *d <= 'h') from_file = *d - 'a';
+        else if (*d >= '1' && *d <= '8') from_rank = *d - '1';
+        else if (*d != 'x' && *d != ':' && *d != '-') return false;
+    }
+
+    int found = -1;
+    for (int i = 0; i < count; i++) {
+        Move m = moves[i];
+        int from = MOVE_FROM(m);
+        if (MOVE_TO(m) != to || m.promo != promo) continue;
+        if (pos_piece_on(pos, from) * pos->side != type) continue;
+        if (from_file >= 0 && SQ_COL(from) != from_file) continue;
+        if (from_rank >= 0 && (from >> 3) != from_rank) continue;
+        if (found >= 0) return false;   // ambiguous
+        found = i;
+    }
+    if (found < 0) return false;
+    *out = moves[found];
+    return true;
+}
+
+bool move_parse(const Position *pos, const char *str, Move *out) {
+    return move_from_uci(pos, str, out) || move_from_san(pos, str, out);
+}
+
+void move_to_san(const Position *pos, Move m, char *buf) {
+    int from = MOVE_FROM(m), to = MOVE_TO(m);
+    int type = pos_piece_on(pos, from) * pos->side;
+    char *p = buf;
+
+    if (m.flags & MOVE_CASTLE) {
+        strcpy(p, m.tc == 6 ? "O-O" : "O-O-O");
+        p += strlen(p);
+    } else {
+        if (type == W_PAWN) {
+            if (m.flags & MOVE_CAPTURE) *p++ = (char)('a' + m.fc);
+        } else {
+            *p++ = san_letters[type];
+            // Name the origin file, else rank, else both, when another piece
+            // of the same type can reach the square
+            Move moves[MAX_MOVES];
+            int count = generate_moves(pos, moves);
+            bool clash = false, same_file = false, same_rank = false;
+            for (int i = 0; i < count; i++) {
+                int other = MOVE_FROM(moves[i]);
+                if (other == from || MOVE_TO(moves[i]) != to) continue;
+                if (pos_piece_on(pos, other) * pos->side != type) continue;
+                clash = true;
+                if (SQ_COL(other) == SQ_COL(from)) same_file = true;
+                if ((other >> 3) == (from >> 3)) same_rank = true;
+            }
+            if (clash && (!same_file || same_rank)) *p++ = (char)('a' + m.fc);
+            if (clash && same_file) *p++ = (char)('1' + (from >> 3));
+        }
+        if (m.flags & MOVE_CAPTURE) *p++ = 'x';
+        *p++ = (char)('a' + m.tc);
+        *p++ = (char)('1' + (to >> 3));
+        if (m.promo != EMPTY) {
+            *p++ = '=';
+            *p++ = san_letters[m.promo];
+        }
+    }
+
+    Position after = *pos;
+    Undo undo;
+    make_move(&after, m, &undo);
+    if (square_attacked(&after, after.king_sq[COLOR_IDX(after.side)], -after.side))
+        *p++ = has_legal_moves(&after) ? '+' : '#';
+    *p = '\0';
+}
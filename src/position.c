@@ -0,0 +1,200 @@
+#include "position.h"
+#include "attacks.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+uint64_t zobrist_piece[2][7][64];
+uint64_t zobrist_castling[16];
+uint64_t zobrist_ep[8];
+uint64_t zobrist_side;
+
+static uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void zobrist_init(void) {
+    uint64_t state = 0x5674726578ULL;
+    for (int c = 0; c < 2; c++)
+        for (int type = W_PAWN; type <= W_KING; type++)
+            for (int sq = 0; sq < 64; sq++)
+                zobrist_piece[c][type][sq] = splitmix64(&state);
+    // Castling keys are XOR combinations of one key per right, so any subset hashes consistently
+    uint64_t rights[4];
+    for (int i = 0; i < 4; i++) rights[i] = splitmix64(&state);
+    for (int cr = 0; cr < 16; cr++) {
+        zobrist_castling[cr] = 0;
+        for (int i = 0; i < 4; i++)
+            if (cr & (1 << i)) zobrist_castling[cr] ^= rights[i];
+    }
+    for (int f = 0; f < 8; f++) zobrist_ep[f] = splitmix64(&state);
+    zobrist_side = splitmix64(&state);
+}
+
+uint64_t position_compute_key(const Position *pos) {
+    uint64_t key = 0;
+    for (int c = 0; c < 2; c++) {
+        for (int type = W_PAWN; type <= W_KING; type++) {
+            Bitboard b = pos->by_type[type] & pos->by_color[c];
+            while (b) key ^= zobrist_piece[c][type][bb_pop_lsb(&b)];
+        }
+    }
+    key ^= zobrist_castling[pos->castling];
+    if (pos->ep_square != SQ_NONE) key ^= zobrist_ep[pos->ep_square & 7];
+    if (pos->side < 0) key ^= zobrist_side;
+    return key;
+}
+
+Score position_compute_psq(const Position *pos) {
+    Score psq = 0;
+    for (int c = 0; c < 2; c++) {
+        for (int type = W_PAWN; type <= W_KING; type++) {
+            Bitboard b = pos->by_type[type] & pos->by_color[c];
+            while (b) psq += psqt[c][type][bb_pop_lsb(&b)];
+        }
+    }
+    return psq;
+}
+
+// En-passant target worth recording: a pawn of the side to move can capture onto it
+static bool ep_capturable(const Position *pos, int ep) {
+    if (ep == SQ_NONE || (ep >> 3) != ((pos->side > 0) ? 5 : 2)) return false;
+    Bitboard capturers = 0;
+    if ((ep & 7) > 0) capturers |= SQ_BB(ep - 8 * pos->side - 1);
+    if ((ep & 7) < 7) capturers |= SQ_BB(ep - 8 * pos->side + 1);
+    return (capturers & pos_pieces(pos, pos->side, W_PAWN)) != 0;
+}
+
+void position_clear(Position *pos) {
+    memset(pos, 0, sizeof(*pos));
+    pos->king_sq[0] = pos->king_sq[1] = SQ_NONE;
+    pos->side = 1;
+    pos->ep_square = SQ_NONE;
+    pos->fullmove = 1;
+}
+
+void position_put_piece(Position *pos, int piece, int sq) {
+    Bitboard b = SQ_BB(sq);
+    int type = (piece > 0) ? piece : -piece;
+    pos->by_type[type] |= b;
+    pos->by_type[EMPTY] |= b;
+    pos->by_color[COLOR_IDX(piece)] |= b;
+    if (type == W_KING) pos->king_sq[COLOR_IDX(piece)] = (int8_t)sq;
+    pos->psq += psqt[COLOR_IDX(piece)][type][sq];
+    pos->phase = (uint8_t)(pos->phase + phase_weight[type]);
+}
+
+void position_remove_piece(Position *pos, int sq) {
+    int piece = pos_piece_on(pos, sq);
+    if (piece == EMPTY) return;
+    int type = (piece > 0) ? piece : -piece;
+    pos->psq -= psqt[COLOR_IDX(piece)][type][sq];
+    pos->phase = (uint8_t)(pos->phase - phase_weight[type]);
+    Bitboard clear = ~SQ_BB(sq);
+    for (int type = EMPTY; type <= W_KING; type++) pos->by_type[type] &= clear;
+    pos->by_color[0] &= clear;
+    pos->by_color[1] &= clear;
+}
+
+void position_from_board(Position *pos, int board[8][8], int side, int castling, int ep_square) {
+    position_clear(pos);
+    for (int r = 0; r < 8; r++)
+        for (int c = 0; c < 8; c++)
+            if (board[r][c] != EMPTY) position_put_piece(pos, board[r][c], SQ(r, c));
+    pos->side = (int8_t)((side > 0) ? 1 : -1);
+
+    // Keep only rights that can still be exercised from this placement
+    if (board[7][4] != W_KING) castling &= ~(CASTLE_WK | CASTLE_WQ);
+    if (board[0][4] != B_KING) castling &= ~(CASTLE_BK | CASTLE_BQ);
+    if (board[7][7] != W_ROOK) castling &= ~CASTLE_WK;
+    if (board[7][0] != W_ROOK) castling &= ~CASTLE_WQ;
+    if (board[0][7] != B_ROOK) castling &= ~CASTLE_BK;
+    if (board[0][0] != B_ROOK) castling &= ~CASTLE_BQ;
+    pos->castling = (uint8_t)(castling & CASTLE_ALL);
+    pos->ep_square = (int8_t)(ep_capturable(pos, ep_square) ? ep_square : SQ_NONE);
+    pos->key = position_compute_key(pos);
+}
+
+void position_to_board(const Position *pos, int board[8][8]) {
+    for (int r = 0; r < 8; r++)
+        for (int c = 0; c < 8; c++)
+            board[r][c] = pos_piece_on(pos, SQ(r, c));
+}
+
+bool position_from_fen(Position *pos, const char *fen) {
+    static const char piece_chars[] = "PRNBQK";
+    position_clear(pos);
+
+    // 1. Placement, rank 8 first
+    int rank = 7, file = 0;
+    const char *p = fen;
+    for (; *p && *p != ' '; p++) {
+        if (*p == '/') {
+            if (file != 8 || rank == 0) return false;
+            rank--; file = 0;
+        } else if (*p >= '1' && *p <= '8') {
+            file += *p - '0';
+            if (file > 8) return false;
+        } else {
+            const char *found = strchr(piece_chars, toupper((unsigned char)*p));
+            if (!found || file > 7) return false;
+            int type = (int)(found - piece_chars) + 1;
+            position_put_piece(pos, isupper((unsigned char)*p) ? type : -type, rank * 8 + file);
+            file++;
+        }
+    }
+    if (rank != 0 || file != 8 || *p != ' ') return false;
+
+    // 2. Side to move
+    p++;
+    if (*p != 'w' && *p != 'b') return false;
+    pos->side = (*p == 'w') ? 1 : -1;
+    p++;
+
+    // Only positions the move generator can handle: one king a side, no
+    // pawns on the back ranks, and the side that just moved not in check
+    const Bitboard back_ranks = 0xFF000000000000FFULL;
+    if (bb_count(pos_pieces(pos, 1, W_KING)) != 1 || bb_count(pos_pieces(pos, -1, W_KING)) != 1) return false;
+    if (pos->by_type[W_PAWN] & back_ranks) return false;
+    if (square_attacked(pos, pos->king_sq[COLOR_IDX(-pos->side)], pos->side)) return false;
+
+    // 3. Castling rights (optional from here on)
+    while (*p == ' ') p++;
+    for (; *p && *p != ' '; p++) {
+        if (*p == 'K') pos->castling |= CASTLE_WK;
+        else if (*p == 'Q') pos->castling |= CASTLE_WQ;
+        else if (*p == 'k') pos->castling |= CASTLE_BK;
+        else if (*p == 'q') pos->castling |= CASTLE_BQ;
+        else if (*p != '-') return false;
+    }
+
+    // 4. En-passant target, kept only when a pawn can actually capture there
+    while (*p == ' ') p++;
+    if (*p >= 'a' && *p <= 'h' && (p[1] == '3' || p[1] == '6')) {
+        int ep = (p[1] - '1') * 8 + (p[0] - 'a');
+        if (ep_capturable(pos, ep)) pos->ep_square = (int8_t)ep;
+        p += 2;
+    } else if (*p == '-') {
+        p++;
+    }
+
+    // 5-6. Move counters
+    int halfmove = 0, fullmove = 1;
+    if (sscanf(p, "%d %d", &halfmove, &fullmove) >= 1) {
+        pos->halfmove = (uint8_t)(halfmove < 0 ? 0 : halfmove > 255 ? 255 : halfmove);
+        pos->fullmove = (uint16_t)(fullmove < 1 ? 1 : fullmove);
+    }
+
+    // Drop rights the placement contradicts, as position_from_board does
+    if (!(pos_pieces(pos, 1, W_KING) & SQ_BB(4))) pos->castling &= ~(CASTLE_WK | CASTLE_WQ);
+    if (!(pos_pieces(pos, -1, W_KING) & SQ_BB(60))) pos->castling &= ~(CASTLE_BK | CASTLE_BQ);
+    if (!(pos_pieces(pos, 1, W_ROOK) & SQ_BB(7))) pos->castling &= ~CASTLE_WK;
+    if (!(pos_pieces(pos, 1, W_ROOK) & SQ_BB(0))) pos->castling &= ~CASTLE_WQ;
+    if (!(pos_pieces(pos, -1, W_ROOK) & SQ_BB(63))) pos->castling &= ~CASTLE_BK;
+    if (!(pos_pieces(pos, -1, W_ROOK) & SQ_BB(56))) pos->castling &= ~CASTLE_BQ;
+    pos->key = position_compute_key(pos);
+    return true;
+}
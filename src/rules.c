@@ -0,0 +1,63 @@
+#include "rules.h"
+#include "attacks.h"
+#include "movegen.h"
+#include <string.h>
+
+#define LIGHT_SQUARES 0x55AA55AA55AA55AAULL
+
+void keys_clear(KeyHistory *history) {
+    history->count = 0;
+}
+
+void keys_push(KeyHistory *history, uint64_t key, int halfmove) {
+    if (halfmove == 0) {
+        // Nothing before an irreversible move can repeat
+        history->count = 0;
+        return;
+    }
+    if (history->count == MAX_GAME_PLIES) {
+        memmove(history->keys, history->keys + 1, (MAX_GAME_PLIES - 1) * sizeof(uint64_t));
+        history->count--;
+    }
+    history->keys[history->count++] = key;
+}
+
+int repetition_count(const Position *pos, const KeyHistory *history) {
+    if (!history) return 0;
+    int count = 0;
+    int reach = pos->halfmove < history->count ? pos->halfmove : history->count;
+    // Same side to move only: every second ply back
+    for (int i = 2; i <= reach; i += 2)
+        if (history->keys[history->count - i] == pos->key) count++;
+    return count;
+}
+
+bool insufficient_material(const Position *pos) {
+    if (pos->by_type[W_PAWN] | pos->by_type[W_ROOK] | pos->by_type[W_QUEEN]) return false;
+    Bitboard knights = pos->by_type[W_KNIGHT], bishops = pos->by_type[W_BISHOP];
+    if (bb_count(knights | bishops) <= 1) return true;
+    return !knights && (!(bishops & LIGHT_SQUARES) || !(bishops & ~LIGHT_SQUARES));
+}
+
+GameStatus position_status(const Position *pos, const KeyHistory *history) {
+    if (!has_legal_moves(pos)) {
+        int ksq = pos->king_sq[COLOR_IDX(pos->side)];
+        if (ksq != SQ_NONE && square_attacked(pos, ksq, -pos->side)) return GAME_CHECKMATE;
+        return GAME_STALEMATE;
+    }
+    if (insufficient_material(pos)) return GAME_INSUFFICIENT_MATERIAL;
+    if (repetition_count(pos, history) >= 2) return GAME_THREEFOLD;
+    if (pos->halfmove >= 100) return GAME_FIFTY_MOVE;
+    return GAME_ONGOING;
+}
+
+const char *game_status_name(GameStatus status) {
+    switch (status) {
+        case GAME_CHECKMATE: return "Checkmate";
+        case GAME_STALEMATE: return "Stalemate";
+        case GAME_THREEFOLD: return "Draw by threefold repetition";
+        case GAME_FIFTY_MOVE: return "Draw by the fifty-move rule";
+        case GAME_INSUFFICIENT_MATERIAL: return "Draw by insufficient material";
+        default: return "Ongoing";
+    }
+}
@@ -0,0 +1,710 @@
+#include "search.h"
+#include "attacks.h"
+#include "eval.h"
+#include "egtb.h"
+#include "nnue.h"
+#include "see.h"
+#include "tt.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#define POLL_MASK 1023
+
+// Move ordering bands, highest first: hash move, captures and queen
+// promotions that do not lose material (MVV-LVA), the two killers,
+// losing captures, then quiet moves by history.
+#define ORDER_TT_MOVE      (1 << 30)
+#define ORDER_CAPTURE      (1 << 29)
+#define ORDER_KILLER       (1 << 28)
+#define ORDER_BAD_CAPTURE  (1 << 27)
+#define HISTORY_MAX        (1 << 20)
+
+// Aspiration window half-width, doubled after each failure up to a full window
+#define ASPIRATION_DELTA 25
+#define ASPIRATION_MAX   800
+
+// Rough piece worth for MVV-LVA, indexed by piece type
+static const int order_value[7] = {0, 1, 5, 3, 3, 9, 20};
+
+// Lazy SMP: helper threads run the same iterative deepening on the same root
+// and only share the transposition table. Each helper skips a different set
+// of depths, so the threads spread over neighbouring iterations and fill the
+// table with entries the main thread then hits.
+static const int skip_size[20]  = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+static const int skip_phase[20] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+static int search_threads = 1;
+
+typedef struct SearchWorker SearchWorker;
+
+// State shared by all threads of one search
+typedef struct {
+    const Position *root;
+    const KeyHistory *history;
+    const SearchLimits *limits;
+    TTable *table;
+    double start_ms;
+    bool pondering;             // clock on hold until limits->ponder drops (main thread only)
+    uint64_t node_base;         // nodes searched while pondering; the node budget starts after them
+    bool abort;                 // set by the main thread to end the helpers; atomic access only
+    SearchWorker *workers;
+    int worker_count;
+} SearchShared;
+
+// Per-thread search state, threaded through the recursion
+struct SearchWorker {
+    int id;                     // 0 is the main thread
+    SearchShared *shared;
+    Position pos;
+    Undo undo[MAX_PLY];
+    uint64_t keys[MAX_GAME_PLIES + MAX_PLY];   // game history, then the current search path
+    int key_base;                              // index of the root in keys
+    uint64_t nodes;             // this thread's count, plain: bumped at every node
+    uint64_t published_nodes;   // copy of nodes for the main thread, stored at each poll; atomic access only
+    uint16_t killers[MAX_PLY][2];   // quiet moves that caused a cutoff, per ply
+    int history[2][64][64];         // [COLOR_IDX(side)][from][to] cutoff credit for quiet moves
+    bool can_stop;      // false until the first iteration has completed
+    bool stopped;
+    SearchResult result;        // last completed iteration
+    int line_scores[MAX_MULTIPV];   // per MultiPV line, last completed iteration
+    SearchStats stats;          // this thread's counters; nodes, depth and time are filled in on read
+};
+
+// The search whose report callback is running on this thread, for search_current_stats
+static __thread const SearchShared *reporting;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec * 1e-6;
+}
+
+void search_set_threads(int threads) {
+    search_threads = threads < 1 ? 1 : threads > MAX_SEARCH_THREADS ? MAX_SEARCH_THREADS : threads;
+}
+
+int search_get_threads(void) {
+    return search_threads;
+}
+
+static uint64_t helper_nodes(const SearchWorker *w) {
+    return __atomic_load_n(&w->published_nodes, __ATOMIC_RELAXED);
+}
+
+// Main thread only: its own count plus what the helpers last published,
+// which lags each of them by under POLL_MASK nodes
+static uint64_t total_nodes(const SearchShared *shared) {
+    uint64_t nodes = shared->workers[0].nodes;
+    for (int i = 1; i < shared->worker_count; i++) nodes += helper_nodes(&shared->workers[i]);
+    return nodes;
+}
+
+// Sums the threads' counters (main thread only). Helpers may still be
+// counting, so a read during the search is a close snapshot, not an exact one.
+static void collect_stats(const SearchShared *shared, SearchStats *out) {
+    const SearchWorker *main_worker = &shared->workers[0];
+    *out = main_worker->stats;
+    out->nodes = total_nodes(shared);
+    for (int i = 1; i < shared->worker_count; i++) {
+        const SearchStats *s = &shared->workers[i].stats;
+        out->qnodes += s->qnodes;
+        out->tt_probes += s->tt_probes;
+        out->tt_hits += s->tt_hits;
+        out->tt_cutoffs += s->tt_cutoffs;
+        out->fail_highs += s->fail_highs;
+        out->first_move_fail_highs += s->first_move_fail_highs;
+        out->null_tries += s->null_tries;
+        out->null_cutoffs += s->null_cutoffs;
+        out->lmr_researches += s->lmr_researches;
+        out->pvs_researches += s->pvs_researches;
+        if (s->seldepth > out->seldepth) out->seldepth = s->seldepth;
+    }
+    out->depth = main_worker->result.depth;
+    out->time_ms = (int)(now_ms() - shared->start_ms);
+    out->nps = out->time_ms > 0 ? out->nodes * 1000 / (uint64_t)out->time_ms : 0;
+}
+
+void search_current_stats(SearchStats *out) {
+    if (reporting) collect_stats(reporting, out);
+    else memset(out, 0, sizeof(*out));
+}
+
+// True while searching on the opponent's time; the moment the ponder flag
+// drops, the clock and the node budget start from now
+static bool still_pondering(SearchShared *shared) {
+    if (!shared->pondering) return false;
+    if (*shared->limits->ponder) return true;
+    shared->pondering = false;
+    shared->start_ms = now_ms();
+    shared->node_base = total_nodes(shared);
+    return false;
+}
+
+// Helpers only watch the abort flag; the main thread owns the limits
+static void check_limits(SearchWorker *w) {
+    SearchShared *shared = w->shared;
+    const SearchLimits *l = shared->limits;
+    if (w->id != 0) {
+        __atomic_store_n(&w->published_nodes, w->nodes, __ATOMIC_RELAXED);
+        if (__atomic_load_n(&shared->abort, __ATOMIC_RELAXED)) w->stopped = true;
+        return;
+    }
+    if (!w->can_stop) return;
+    if ((l->stop && *l->stop) ||
+        (l->nodes && !still_pondering(shared) && total_nodes(shared) - shared->node_base >= l->nodes) ||
+        (l->movetime_ms && !still_pondering(shared) && now_ms() - shared->start_ms >= l->movetime_ms))
+        w->stopped = true;
+}
+
+static bool is_quiet(Move m) {
+    return !(m.flags & (MOVE_CAPTURE | MOVE_EN_PASSANT)) && m.promo != W_QUEEN;
+}
+
+// Ordering key for every move; the caller picks them out lazily with next_move
+static void score_moves(const SearchWorker *w, const Move *moves, int *scores, int count, uint16_t tt_move, int ply) {
+    const Position *pos = &w->pos;
+    const uint16_t *killers = w->killers[ply];
+    int us = COLOR_IDX(pos->side);
+    for (int i = 0; i < count; i++) {
+        Move m = moves[i];
+        uint16_t packed = move_pack(m);
+        if (packed == tt_move) {
+            scores[i] = ORDER_TT_MOVE;
+        } else if (!is_quiet(m)) {
+            int victim = (m.flags & MOVE_EN_PASSANT) ? W_PAWN : abs(pos_piece_on(pos, MOVE_TO(m)));
+            int attacker = abs(pos_piece_on(pos, MOVE_FROM(m)));
+            int mvv_lva = 32 * (order_value[victim] + order_value[m.promo]) - order_value[attacker];
+            // Only a capture by a more valuable piece can lose material
+            bool losing = order_value[attacker] > order_value[victim] + order_value[m.promo] && see(pos, m) < 0;
+            scores[i] = (losing ? ORDER_BAD_CAPTURE : ORDER_CAPTURE) + mvv_lva;
+        } else if (packed == killers[0]) {
+            scores[i] = ORDER_KILLER + 1;
+        } else if (packed == killers[1]) {
+            scores[i] = ORDER_KILLER;
+        } else {
+            scores[i] = w->history[us][MOVE_FROM(m)][MOVE_TO(m)];
+        }
+    }
+}
+
+// Incremental selection: swap the best remaining move into slot i
+static Move next_move(Move *moves, int *scores, int count, int i) {
+    int best = i;
+    for (int j = i + 1; j < count; j++)
+        if (scores[j] > scores[best]) best = j;
+    if (best != i) {
+        Move m = moves[i]; moves[i] = moves[best]; moves[best] = m;
+        int s = scores[i]; scores[i] = scores[best]; scores[best] = s;
+    }
+    return moves[i];
+}
+
+// Credit a quiet move that failed high: killer slot for this ply, history by depth²
+static void update_quiet_stats(SearchWorker *w, Move m, int depth, int ply) {
+    uint16_t packed = move_pack(m);
+    uint16_t *killers = w->killers[ply];
+    if (killers[0] != packed) {
+        killers[1] = killers[0];
+        killers[0] = packed;
+    }
+
+    int (*history)[64] = w->history[COLOR_IDX(w->pos.side)];
+    int *h = &history[MOVE_FROM(m)][MOVE_TO(m)];
+    *h += depth * depth;
+    if (*h >= HISTORY_MAX) {
+        // Keep history below the killer band, preserving relative order
+        for (int from = 0; from < 64; from++)
+            for (int to = 0; to < 64; to++)
+                history[from][to] /= 2;
+    }
+}
+
+// The table stores mate scores as distance from the stored node, not the root
+static int score_to_tt(int score, int ply) {
+    return score >= MATE_BOUND ? score + ply : score <= -MATE_BOUND ? score - ply : score;
+}
+
+static int score_from_tt(int score, int ply) {
+    return score >= MATE_BOUND ? score - ply : score <= -MATE_BOUND ? score + ply : score;
+}
+
+// Records the node on the key path and reports a draw by rule: a repeated
+// position (once is enough inside the tree), fifty moves, or bare material
+static bool is_draw(SearchWorker *w, int ply) {
+    const Position *pos = &w->pos;
+    int index = w->key_base + ply;
+    w->keys[index] = pos->key;
+    if (pos->halfmove >= 100 || insufficient_material(pos)) return true;
+    int reach = pos->halfmove < index ? pos->halfmove : index;
+    for (int i = 4; i <= reach; i += 2)
+        if (w->keys[index - i] == pos->key) return true;
+    return false;
+}
+
+// Exact score from the endgame tables, mate distances counted from the root
+static bool probe_endgame(const Position *pos, int ply, int *score) {
+    int plies;
+    switch (egtb_probe(pos, &plies)) {
+        case EGTB_WIN:  *score = MATE_SCORE - ply - plies; return true;
+        case EGTB_LOSS: *score = -MATE_SCORE + ply + plies; return true;
+        case EGTB_DRAW: *score = 0; return true;
+        default:        return false;
+    }
+}
+
+static bool in_check(const Position *pos) {
+    return square_attacked(pos, pos->king_sq[COLOR_IDX(pos->side)], -pos->side);
+}
+
+// Quiescence search: resolve captures and queen promotions past the horizon
+// so the static evaluation is only taken in quiet positions. The side to
+// move may stand pat on the evaluation; captures that lose material by SEE
+// are skipped. In check every evasion is searched instead.
+static int quiesce(SearchWorker *w, int ply, int alpha, int beta) {
+    Position *pos = &w->pos;
+    if ((++w->nodes & POLL_MASK) == 0) check_limits(w);
+    if (w->stopped) return 0;
+    w->stats.qnodes++;
+    if (ply > w->stats.seldepth) w->stats.seldepth = ply;
+
+    int tb_score;
+    if (probe_endgame(pos, ply, &tb_score)) return tb_score;
+
+    bool check = in_check(pos);
+    Move moves[MAX_MOVES];
+    int move_count;
+    int best_eval = -VALUE_INF;
+    if (check) {
+        move_count = generate_moves(pos, moves);
+        if (move_count == 0) return -MATE_SCORE + ply;
+        if (ply >= MAX_PLY - 1) return evaluate(pos);
+    } else {
+        best_eval = evaluate(pos);
+        if (best_eval >= beta || ply >= MAX_PLY - 1) return best_eval;
+        if (best_eval > alpha) alpha = best_eval;
+        move_count = generate_captures(pos, moves);
+    }
+
+    int scores[MAX_MOVES];
+    score_moves(w, moves, scores, move_count, 0, ply);
+    Undo *undo = &w->undo[ply];
+
+    for (int i = 0; i < move_count; i++) {
+        Move m = next_move(moves, scores, move_count, i);
+        if (!check && ((m.promo != EMPTY && m.promo != W_QUEEN) || scores[i] < ORDER_CAPTURE))
+            continue; // underpromotion or losing capture
+        make_move(pos, m, undo);
+        int eval = -quiesce(w, ply+1, -beta, -alpha);
+        unmake_move(pos, m, undo);
+        if (w->stopped) return 0;
+
+        if (eval > best_eval) best_eval = eval;
+        if (eval > alpha) alpha = eval;
+        if (alpha >= beta) break;
+    }
+    return best_eval;
+}
+
+// Late-move reduction in plies by [depth][move index]; grows with both
+static int lmr_table[64][64];
+static pthread_once_t lmr_once = PTHREAD_ONCE_INIT;
+
+static void lmr_init(void) {
+    for (int d = 1; d < 64; d++)
+        for (int i = 1; i < 64; i++)
+            lmr_table[d][i] = (int)(0.75 + log(d) * log(i) / 2.25);
+}
+
+// Null-move pruning is unsound in zugzwang, which is only common when the
+// side to move has nothing but king and pawns
+static bool has_pieces(const Position *pos) {
+    Bitboard own = pos->by_color[COLOR_IDX(pos->side)];
+    return (own & ~(pos->by_type[W_PAWN] | pos->by_type[W_KING])) != 0;
+}
+
+// Negamax alpha-beta below the root, scores for the side to move.
+// Once the worker is stopped the returned value is meaningless.
+// allow_null is false right after a null move, so two never follow each other.
+static int negamax(SearchWorker *w, int depth, int ply, int alpha, int beta, bool allow_null) {
+    Position *pos = &w->pos;
+    if (depth <= 0) return quiesce(w, ply, alpha, beta);
+    if ((++w->nodes & POLL_MASK) == 0) check_limits(w);
+    if (w->stopped) return 0;
+    if (ply > w->stats.seldepth) w->stats.seldepth = ply;
+    if (is_draw(w, ply)) return 0;
+
+    int tb_score;
+    if (probe_endgame(pos, ply, &tb_score)) return tb_score;
+
+    unsigned disabled = w->shared->limits->disable;
+    int alpha_orig = alpha;
+    uint16_t tt_move = 0;
+    TTEntry tte;
+    w->stats.tt_probes++;
+    if (ttable_probe(w->shared->table, pos->key, &tte)) {
+        w->stats.tt_hits++;
+        tt_move = tte.move;
+        TTBound bound = (TTBound)(tte.bound_gen & 3);
+        int tt_score = score_from_tt(tte.score, ply);
+        if (tte.depth >= depth &&
+            (bound == TT_EXACT || (bound == TT_LOWER && tt_score >= beta) || (bound == TT_UPPER && tt_score <= alpha))) {
+            w->stats.tt_cutoffs++;
+            return tt_score;
+        }
+    }
+
+    if (ply >= MAX_PLY - 1)
+        return evaluate(pos);
+    bool check = in_check(pos);
+    Undo *undo = &w->undo[ply];
+
+    // Null move: if passing still fails high on a reduced search, a real move
+    // will too. Adaptive: deeper nodes reduce by one ply more.
+    if (!(disabled & SEARCH_NO_NULL_MOVE) && allow_null && !check && depth >= 3 &&
+        beta - alpha == 1 && !score_is_mate(beta) && has_pieces(pos) && evaluate(pos) >= beta) {
+        int r = depth > 6 ? 3 : 2;
+        w->stats.null_tries++;
+        make_null_move(pos, undo);
+        int eval = -negamax(w, depth - 1 - r, ply + 1, -beta, -beta + 1, false);
+        unmake_null_move(pos, undo);
+        if (w->stopped) return 0;
+        if (eval >= beta) {
+            w->stats.null_cutoffs++;
+            return beta;
+        }
+    }
+
+    Move moves[MAX_MOVES];
+    int move_count = generate_moves(pos, moves);
+
+    if (move_count == 0)
+        return check ? -MATE_SCORE + ply : 0; // checkmate or stalemate
+
+    int scores[MAX_MOVES];
+    score_moves(w, moves, scores, move_count, tt_move, ply);
+
+    Move best_move = moves[0];
+    int best_eval = -VALUE_INF;
+    bool pvs = !(disabled & SEARCH_NO_PVS);
+    const int (*history)[64] = w->history[COLOR_IDX(pos->side)];
+
+    for (int i = 0; i < move_count; i++) {
+        Move m = next_move(moves, scores, move_count, i);
+        bool quiet = is_quiet(m);
+        int hist = history[MOVE_FROM(m)][MOVE_TO(m)];
+        make_move(pos, m, undo);
+        bool gives_check = in_check(pos);
+        int new_depth = depth - 1 + (gives_check && !(disabled & SEARCH_NO_CHECK_EXT));
+
+        int eval;
+        if (i == 0) {
+            eval = -negamax(w, new_depth, ply+1, -beta, -alpha, true);
+        } else {
+            // Late quiet moves rarely matter: search them shallower first,
+            // less so when they have a good history
+            int r = 0;
+            if (!(disabled & SEARCH_NO_LMR) && depth >= 3 && i >= 3 && quiet && !check && !gives_check &&
+                scores[i] < ORDER_KILLER) {
+                r = lmr_table[depth < 64 ? depth : 63][i < 64 ? i : 63];
+                if (hist > HISTORY_MAX / 16) r--;
+                if (r > new_depth - 1) r = new_depth - 1;
+                if (r < 0) r = 0;
+            }
+            // PVS: prove the move no better than alpha with a zero window,
+            // searching the full window only when that fails
+            int probe_beta = pvs ? alpha + 1 : beta;
+            eval = -negamax(w, new_depth - r, ply+1, -probe_beta, -alpha, true);
+            if (r > 0 && eval > alpha && !w->stopped) {
+                w->stats.lmr_researches++;
+                eval = -negamax(w, new_depth, ply+1, -probe_beta, -alpha, true);
+            }
+            if (pvs && eval > alpha && eval < beta && !w->stopped) {
+                w->stats.pvs_researches++;
+                eval = -negamax(w, new_depth, ply+1, -beta, -alpha, true);
+            }
+        }
+        unmake_move(pos, m, undo);
+        if (w->stopped) return 0;
+
+        if (eval > best_eval) {
+            best_eval = eval;
+            best_move = m;
+        }
+        if (eval > alpha) alpha = eval;
+        if (alpha >= beta) {
+            w->stats.fail_highs++;
+            if (i == 0) w->stats.first_move_fail_highs++;
+            if (quiet) update_quiet_stats(w, m, depth, ply);
+            break;
+        }
+    }
+
+    TTBound bound = (best_eval <= alpha_orig) ? TT_UPPER : (best_eval >= beta) ? TT_LOWER : TT_EXACT;
+    ttable_store(w->shared->table, pos->key, depth, bound, score_to_tt(best_eval, ply), move_pack(best_move));
+    return best_eval;
+}
+
+// One root iteration inside the window [alpha, beta): a result below alpha,
+// or at or above beta, is only a bound. Each move's window is widened
+// by one so moves tying the best return exact scores; they are chosen
+// between at random, and the choice is moved to the front of moves so the
+// next iteration searches it first. MultiPV passes the moves left after
+// excluding the lines above, so the caller stores the root in the table.
+static int search_root(SearchWorker *w, Move *moves, int move_count, int depth, int alpha, int beta) {
+    Position *pos = &w->pos;
+    unsigned disabled = w->shared->limits->disable;
+    int best_indices[MAX_MOVES];
+    int best_count = 0;
+    int best_eval = -VALUE_INF;
+
+    for (int i = 0; i < move_count; i++) {
+        make_move(pos, moves[i], &w->undo[0]);
+        int new_depth = depth - 1 + (in_check(pos) && !(disabled & SEARCH_NO_CHECK_EXT));
+        int eval;
+        if (i == 0 || (disabled & SEARCH_NO_PVS)) {
+            eval = -negamax(w, new_depth, 1, -beta, -(alpha - 1), true);
+        } else {
+            // Zero window just below alpha: anything that ties or beats it is re-searched
+            eval = -negamax(w, new_depth, 1, -alpha, -(alpha - 1), true);
+            if (eval >= alpha && eval < beta && !w->stopped)
+                eval = -negamax(w, new_depth, 1, -beta, -(alpha - 1), true);
+        }
+        unmake_move(pos, moves[i], &w->undo[0]);
+        if (w->stopped) return 0;
+
+        if (eval > best_eval) {
+            best_eval = eval;
+            best_indices[0] = i;
+            best_count = 1;
+        } else if (eval == best_eval) {
+            best_indices[best_count++] = i;
+        }
+        if (eval > alpha) alpha = eval;
+        if (eval >= beta) break;
+    }
+
+    int chosen = best_indices[rand() % best_count];
+    Move best = moves[chosen];
+    for (int i = chosen; i > 0; i--) moves[i] = moves[i-1];
+    moves[0] = best;
+    return best_eval;
+}
+
+// Principal variation starting with first, read back from the table. Ends at
+// a position the table has no move for, or one already on the line.
+static int table_pv(const TTable *table, const Position *root, Move first, Move *pv, int max) {
+    Position pos = *root;
+    uint64_t seen[MAX_PLY];
+    int length = 0;
+    Move m = first;
+    while (length < max) {
+        seen[length] = pos.key;
+        Undo undo;
+        make_move(&pos, m, &undo);
+        pv[length++] = m;
+
+        TTEntry e;
+        if (!ttable_probe(table, pos.key, &e) || !e.move) break;
+        bool repeated = false;
+        for (int i = 0; i < length; i++) repeated |= (seen[i] == pos.key);
+        if (repeated) break;
+        Move moves[MAX_MOVES];
+        int count = generate_moves(&pos, moves), i = 0;
+        while (i < count && move_pack(moves[i]) != e.move) i++;
+        if (i == count) break;
+        m = moves[i];
+    }
+    return length;
+}
+
+// Hand the lines of the last iteration to the caller's report hook
+static void report_lines(SearchWorker *w, const Move *moves, int lines, int depth) {
+    SearchShared *shared = w->shared;
+    SearchLine out[MAX_MULTIPV];
+    uint64_t nodes = total_nodes(shared);
+    int time_ms = (int)(now_ms() - shared->start_ms);
+    for (int k = 0; k < lines; k++) {
+        out[k].multipv = k + 1;
+        out[k].depth = depth;
+        out[k].score = w->line_scores[k];
+        out[k].nodes = nodes;
+        out[k].time_ms = time_ms;
+        out[k].pv_length = table_pv(shared->table, shared->root, moves[k], out[k].pv, MAX_PLY);
+    }
+    reporting = shared;
+    shared->limits->report(out, lines, shared->limits->report_ctx);
+    reporting = NULL;
+}
+
+// Iterative deepening for one thread, leaving its last completed iteration in w->result
+static void iterate(SearchWorker *w) {
+    SearchShared *shared = w->shared;
+    const SearchLimits *limits = shared->limits;
+    Move moves[MAX_MOVES];
+    int move_count = generate_moves(&w->pos, moves);
+    nnue_attach(&w->pos);
+
+    // Root order for the first iteration; later ones keep the previous best in front
+    int scores[MAX_MOVES];
+    score_moves(w, moves, scores, move_count, 0, 0);
+    for (int i = 0; i < move_count; i++) next_move(moves, scores, move_count, i);
+
+    int max_depth = (limits->depth > 0 && limits->depth < MAX_PLY) ? limits->depth : MAX_PLY - 1;
+    // MultiPV: line k searches the moves not taken by lines 0..k-1 (main thread only)
+    int lines = (w->id == 0 && limits->multipv > 1) ? limits->multipv : 1;
+    if (lines > MAX_MULTIPV) lines = MAX_MULTIPV;
+    if (lines > move_count) lines = move_count;
+    w->result.best_move = moves[0];
+    double iteration_start = now_ms();
+    for (int depth = 1; depth <= max_depth; depth++) {
+        if (w->id != 0) {
+            int slot = (w->id - 1) % 20;
+            if (depth > 1 && ((depth + skip_phase[slot]) / skip_size[slot]) % 2) continue;
+        }
+        for (int k = 0; k < lines && !w->stopped; k++) {
+            // Aspiration: expect a score near the last one and widen the window on failure
+            int delta = ASPIRATION_DELTA;
+            int alpha = -VALUE_INF, beta = VALUE_INF;
+            int last = w->line_scores[k];
+            if (!(limits->disable & SEARCH_NO_ASPIRATION) && depth >= 5 && !score_is_mate(last)) {
+                alpha = last - delta;
+                beta = last + delta;
+            }
+            int score;
+            for (;;) {
+                score = search_root(w, moves + k, move_count - k, depth, alpha, beta);
+                if (w->stopped || (score >= alpha && score < beta)) break;
+                delta *= 2;
+                if (score < alpha) alpha = score - delta;
+                else beta = score + delta;
+                if (delta > ASPIRATION_MAX || score_is_mate(score)) alpha = -VALUE_INF, beta = VALUE_INF;
+                if (alpha < -VALUE_INF) alpha = -VALUE_INF;
+                if (beta > VALUE_INF) beta = VALUE_INF;
+            }
+            if (w->stopped) break;
+            w->line_scores[k] = score;
+            if (k == 0) ttable_store(shared->table, w->pos.key, depth, TT_EXACT, score, move_pack(moves[0]));
+        }
+        if (w->stopped) break;
+
+        // Later lines can outscore earlier ones once searched deeper: keep them best first
+        for (int i = 1; i < lines; i++) {
+            Move m = moves[i];
+            int s = w->line_scores[i], j = i;
+            for (; j > 0 && w->line_scores[j - 1] < s; j--) {
+                moves[j] = moves[j - 1];
+                w->line_scores[j] = w->line_scores[j - 1];
+            }
+            moves[j] = m;
+            w->line_scores[j] = s;
+        }
+
+        int score = w->line_scores[0];
+        w->result.best_move = moves[0];
+        w->result.score = score;
+        w->result.depth = depth;
+        w->can_stop = true;
+        if (w->id != 0) continue;
+        double now = now_ms();
+        w->stats.iteration_ms[depth - 1] = (int)(now - iteration_start);
+        iteration_start = now;
+        if (limits->report) report_lines(w, moves, lines, depth);
+
+        // A forced move needs no deeper look, and a mate found won't get any better
+        // (unless other lines are wanted too)
+        if (move_count == 1 || (lines == 1 && score_is_mate(score))) break;
+        // The next iteration would take several times longer than all of this one
+        if (limits->movetime_ms && !still_pondering(shared) && (now_ms() - shared->start_ms) * 2 >= limits->movetime_ms)
+            break;
+        check_limits(w);
+        if (w->stopped) break;
+    }
+    if (w->id != 0) __atomic_store_n(&w->published_nodes, w->nodes, __ATOMIC_RELAXED);
+    nnue_detach();
+}
+
+static void *helper_main(void *arg) {
+    iterate((SearchWorker *)arg);
+    return NULL;
+}
+
+static void worker_init(SearchWorker *w, int id, SearchShared *shared) {
+    w->id = id;
+    w->shared = shared;
+    w->pos = *shared->root;
+    w->key_base = 0;
+    if (shared->history) {
+        w->key_base = shared->history->count;
+        memcpy(w->keys, shared->history->keys, (size_t)w->key_base * sizeof(uint64_t));
+    }
+    w->keys[w->key_base] = w->pos.key;
+    w->nodes = 0;
+    w->published_nodes = 0;
+    memset(w->killers, 0, sizeof(w->killers));
+    memset(w->history, 0, sizeof(w->history));
+    w->can_stop = (id != 0);
+    w->stopped = false;
+    memset(&w->result, 0, sizeof(w->result));
+    memset(w->line_scores, 0, sizeof(w->line_scores));
+    memset(&w->stats, 0, sizeof(w->stats));
+}
+
+// Second move of the principal variation
+static bool pv_reply(const TTable *table, const Position *root, Move best, Move *reply) {
+    Move pv[2];
+    if (table_pv(table, root, best, pv, 2) < 2) return false;
+    *reply = pv[1];
+    return true;
+}
+
+bool search(const Position *pos, const KeyHistory *history, const SearchLimits *limits, SearchResult *result) {
+    if (!has_legal_moves(pos)) return false;
+    pthread_once(&lmr_once, lmr_init);
+
+    SearchShared shared;
+    shared.root = pos;
+    shared.history = history;
+    shared.limits = limits;
+    shared.table = limits->table ? limits->table : tt_global();
+    shared.start_ms = now_ms();
+    shared.pondering = limits->ponder && *limits->ponder;
+    shared.node_base = 0;
+    shared.abort = false;
+    shared.worker_count = search_threads;
+    shared.workers = malloc((size_t)shared.worker_count * sizeof(SearchWorker));
+    if (!shared.workers) {
+        fprintf(stderr, "Warning: could not allocate search threads, searching on one.\n");
+        shared.worker_count = 1;
+        shared.workers = malloc(sizeof(SearchWorker));
+        if (!shared.workers) return false;
+    }
+    for (int i = 0; i < shared.worker_count; i++) worker_init(&shared.workers[i], i, &shared);
+
+    if (!limits->keep_table_age) ttable_new_search(shared.table);
+
+    pthread_t threads[MAX_SEARCH_THREADS];
+    int started = 1;
+    for (; started < shared.worker_count; started++) {
+        if (pthread_create(&threads[started], NULL, helper_main, &shared.workers[started]) != 0) {
+            fprintf(stderr, "Warning: could only start %d search threads.\n", started);
+            break;
+        }
+    }
+
+    iterate(&shared.workers[0]);
+
+    __atomic_store_n(&shared.abort, true, __ATOMIC_RELAXED);
+    for (int i = 1; i < started; i++) pthread_join(threads[i], NULL);
+
+    *result = shared.workers[0].result;
+    result->has_ponder = pv_reply(shared.table, pos, result->best_move, &result->ponder_move);
+    collect_stats(&shared, &result->stats);
+    result->nodes = result->stats.nodes;
+    result->time_ms = result->stats.time_ms;
+    free(shared.workers);
+    return true;
+}
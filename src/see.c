@@ -0,0 +1,63 @@
+#include "see.h"
+#include "attacks.h"
+#include <stdlib.h>
+
+static const int see_value[7] = {0, 100, 500, 320, 330, 900, 20000};
+
+// Cheapest attackers first
+static const int see_order[6] = {W_PAWN, W_KNIGHT, W_BISHOP, W_ROOK, W_QUEEN, W_KING};
+
+int see(const Position *pos, Move m) {
+    int from = MOVE_FROM(m), to = MOVE_TO(m);
+    int gain[32], d = 0;
+    Bitboard occ = pos->by_type[EMPTY] ^ SQ_BB(from);
+    Bitboard diagonal = pos->by_type[W_BISHOP] | pos->by_type[W_QUEEN];
+    Bitboard straight = pos->by_type[W_ROOK] | pos->by_type[W_QUEEN];
+
+    int victim = abs(pos_piece_on(pos, to));
+    if (m.flags & MOVE_EN_PASSANT) {
+        victim = W_PAWN;
+        occ ^= SQ_BB(SQ(m.fr, m.tc));
+    }
+    // Value of the piece standing on the target square after each capture
+    int on_target = abs(pos_piece_on(pos, from));
+    gain[0] = see_value[victim];
+    if (m.promo != EMPTY) {
+        gain[0] += see_value[m.promo] - see_value[W_PAWN];
+        on_target = m.promo;
+    }
+
+    Bitboard attackers = attackers_to(pos, to, occ) & occ;
+    int side = -pos->side;
+    while (d < 31) {
+        Bitboard mine = attackers & pos->by_color[COLOR_IDX(side)];
+        if (!mine) break;
+        int type = W_KING;
+        Bitboard b = 0;
+        for (int i = 0; i < 6; i++) {
+            b = mine & pos->by_type[see_order[i]];
+            if (b) { type = see_order[i]; break; }
+        }
+        // The king may only take last
+        if (type == W_KING && (attackers & pos->by_color[COLOR_IDX(-side)])) break;
+
+        d++;
+        gain[d] = see_value[on_target] - gain[d-1];
+        on_target = type;
+
+        occ ^= b & -b;
+        if (type == W_PAWN || type == W_BISHOP || type == W_QUEEN)
+            attackers |= bishop_attacks(to, occ) & diagonal;
+        if (type == W_ROOK || type == W_QUEEN)
+            attackers |= rook_attacks(to, occ) & straight;
+        attackers &= occ;
+        side = -side;
+    }
+
+    // Each side stops recapturing once it would lose by going on
+    while (d > 0) {
+        gain[d-1] = -(-gain[d-1] > gain[d] ? -gain[d-1] : gain[d]);
+        d--;
+    }
+    return gain[0];
+}
@@ -0,0 +1,144 @@
+#include "tt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TT_BUCKET_SIZE 4
+
+// Lockless slot: key_xor holds key ^ data. Aligned 64-bit loads and stores
+// do not tear, so a slot whose words come from two different stores fails
+// the key check and reads as a miss.
+typedef struct {
+    volatile uint64_t key_xor;
+    volatile uint64_t data;
+} TTSlot;
+
+struct TTBucket {
+    TTSlot slots[TT_BUCKET_SIZE];
+};
+
+// data: score bits 0-15, move 16-31, depth 32-39, bound_gen 40-47
+static uint64_t tt_pack(int score, uint16_t move, int depth, uint8_t bound_gen) {
+    return (uint64_t)(uint16_t)score | ((uint64_t)move << 16) | ((uint64_t)(uint8_t)depth << 32) | ((uint64_t)bound_gen << 40);
+}
+
+static void tt_unpack(uint64_t key, uint64_t data, TTEntry *out) {
+    out->key = key;
+    out->score = (int16_t)(uint16_t)data;
+    out->move = (uint16_t)(data >> 16);
+    out->depth = (int8_t)(data >> 32);
+    out->bound_gen = (uint8_t)(data >> 40);
+}
+
+static TTable global_table;
+
+bool ttable_resize(TTable *tt, size_t mb) {
+    size_t buckets = 1;
+    while (buckets * 2 * sizeof(TTBucket) <= mb * 1024 * 1024) buckets *= 2;
+
+    free(tt->buckets);
+    tt->buckets = calloc(buckets, sizeof(TTBucket));
+    if (!tt->buckets) {
+        fprintf(stderr, "Warning: could not allocate %zu MB transposition table.\n", mb);
+        tt->mask = 0;
+        return false;
+    }
+    tt->mask = buckets - 1;
+    tt->generation = 0;
+    return true;
+}
+
+void ttable_free(TTable *tt) {
+    free(tt->buckets);
+    tt->buckets = NULL;
+    tt->mask = 0;
+}
+
+void ttable_clear(TTable *tt) {
+    if (tt->buckets) memset(tt->buckets, 0, (tt->mask + 1) * sizeof(TTBucket));
+    tt->generation = 0;
+}
+
+void ttable_new_search(TTable *tt) {
+    uint8_t generation = __atomic_load_n(&tt->generation, __ATOMIC_RELAXED);
+    __atomic_store_n(&tt->generation, (uint8_t)((generation + 1) & 63), __ATOMIC_RELAXED);
+}
+
+bool ttable_probe(const TTable *tt, uint64_t key, TTEntry *out) {
+    if (!tt->buckets) return false;
+    const TTBucket *bucket = &tt->buckets[key & tt->mask];
+    for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+        uint64_t data = bucket->slots[i].data;
+        if ((bucket->slots[i].key_xor ^ data) == key && (data >> 40 & 3) != TT_NONE) {
+            tt_unpack(key, data, out);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Replacement: same key first, then empty slots, then the shallowest entry,
+// counting each search generation of age as 8 plies of lost depth.
+void ttable_store(TTable *tt, uint64_t key, int depth, TTBound bound, int score, uint16_t move) {
+    if (!tt->buckets) return;
+    TTBucket *bucket = &tt->buckets[key & tt->mask];
+    uint8_t generation = __atomic_load_n(&tt->generation, __ATOMIC_RELAXED);
+    TTSlot *victim = &bucket->slots[0];
+    uint64_t victim_data = victim->data;
+    int victim_worth = 1 << 30;
+
+    for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+        TTSlot *slot = &bucket->slots[i];
+        uint64_t data = slot->data;
+        TTEntry e;
+        tt_unpack(slot->key_xor ^ data, data, &e);
+        if (e.key == key || (e.bound_gen & 3) == TT_NONE) {
+            victim = slot;
+            victim_data = data;
+            break;
+        }
+        int age = (generation - (e.bound_gen >> 2)) & 63;
+        int worth = e.depth - 8 * age;
+        if (worth < victim_worth) {
+            victim_worth = worth;
+            victim = slot;
+            victim_data = data;
+        }
+    }
+
+    // Keep a known best move if this store has none for the same position
+    if (move == 0 && (victim->key_xor ^ victim_data) == key) move = (uint16_t)(victim_data >> 16);
+    uint64_t data = tt_pack(score, move, depth, (uint8_t)(bound | (generation << 2)));
+    victim->data = data;
+    victim->key_xor = key ^ data;
+}
+
+// --- The process-wide table ---
+
+TTable *tt_global(void) {
+    return &global_table;
+}
+
+bool tt_resize(size_t mb) {
+    return ttable_resize(&global_table, mb);
+}
+
+void tt_free(void) {
+    ttable_free(&global_table);
+}
+
+void tt_clear(void) {
+    ttable_clear(&global_table);
+}
+
+void tt_new_search(void) {
+    ttable_new_search(&global_table);
+}
+
+bool tt_probe(uint64_t key, TTEntry *out) {
+    return ttable_probe(&global_table, key, out);
+}
+
+void tt_store(uint64_t key, int depth, TTBound bound, int score, uint16_t move) {
+    ttable_store(&global_table, key, depth, bound, score, move);
+}
@@ -1,9 +1,38 @@
 #include "ui.h"
+#include <stdio.h>
 #include <string.h>
 
+static float percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0f * (float)part / (float)whole : 0.0f;
+}
+
+// Search statistics panel, top right
+static void draw_search_stats(const SearchStats *s) {
+    char lines[8][64];
+    int n = 0;
+    snprintf(lines[n++], sizeof(lines[0]), "Depth %d/%d  %d ms", s->depth, s->seldepth, s->time_ms);
+    snprintf(lines[n++], sizeof(lines[0]), "Nodes %llu  (%llu kn/s)", (unsigned long long)s->nodes,
+             (unsigned long long)(s->nps / 1000));
+    snprintf(lines[n++], sizeof(lines[0]), "Quiescence %.0f%%", percent(s->qnodes, s->nodes));
+    snprintf(lines[n++], sizeof(lines[0]), "TT hits %.0f%%  cutoffs %.0f%%", percent(s->tt_hits, s->tt_probes),
+             percent(s->tt_cutoffs, s->tt_probes));
+    snprintf(lines[n++], sizeof(lines[0]), "First-move cutoffs %.0f%%", percent(s->first_move_fail_highs, s->fail_highs));
+    snprintf(lines[n++], sizeof(lines[0]), "Null moves %llu  (%.0f%% cut)", (unsigned long long)s->null_tries,
+             percent(s->null_cutoffs, s->null_tries));
+    snprintf(lines[n++], sizeof(lines[0]), "Re-searches LMR %llu  PVS %llu", (unsigned long long)s->lmr_researches,
+             (unsigned long long)s->pvs_researches);
+    snprintf(lines[n++], sizeof(lines[0]), "Last iteration %d ms", s->depth > 0 ? s->iteration_ms[s->depth - 1] : 0);
+
+    int w = 330, h = 16 + n * 22;
+    int x = GetScreenWidth() - w - 16, y = 16;
+    DrawRectangle(x, y, w, h, (Color){0,0,0,150});
+    for (int i = 0; i < n; i++) DrawText(lines[i], x + 10, y + 8 + i * 22, 18, i == 0 ? YELLOW : RAYWHITE);
+}
+
 // ... draw_ui as before ...
 void draw_ui(const UIOverlayInfo *info, float logo_alpha) {
     // ... existing overlays ...
+    if (info->show_stats) draw_search_stats(&info->search_stats);
     // Draw version at bottom right
     DrawText("VortexMate v1.0", GetScreenWidth()-230, GetScreenHeight()-36, 26, GRAY);
 }
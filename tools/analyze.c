@@ -0,0 +1,517 @@
+// vortex-analyze: annotates every game in the game history database with
+// per-move evaluations, the engine's best move and blunder flags. A reader
+// pages games out of the games table, a pool of threads searches each
+// position at a fixed node budget, and one writer stores the results in
+// batched transactions. A game counts as done only once its rows are
+// committed, so an interrupted run resumes where it stopped.
+// Headless; links only the engine sources and SQLite.
+#include "search.h"
+#include "notation.h"
+#include "engine.h"
+#include "nnue.h"
+#include "tt.h"
+#include <ctype.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sqlite3.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_ANALYZED_PLIES 512
+// Games fetched per reader query; the read lock is dropped between pages
+#define READ_PAGE 64
+// Games waiting for a worker
+#define QUEUE_SIZE 64
+// Scores are clamped to this before taking differences, so a slower mate or
+// a bigger win on an already won board does not read as a mistake
+#define LOSS_CLAMP 1000
+// Commits tried for the last batch before its games are left for the next run
+#define MAX_WRITE_ATTEMPTS 5
+
+static const char *schema_sql =
+    "CREATE TABLE IF NOT EXISTS analysis ("
+    "game_id INTEGER,"
+    "ply INTEGER,"            // 0 for White's first move
+    "move TEXT,"              // played, SAN
+    "eval INTEGER,"           // before the move, centipawns for White
+    "mate INTEGER,"           // moves to mate before the move, positive if White mates, 0 if none
+    "best_move TEXT,"         // engine's choice, SAN
+    "loss INTEGER,"           // centipawns the played move gave away
+    "blunder INTEGER,"
+    "PRIMARY KEY (game_id, ply));"
+    "CREATE TABLE IF NOT EXISTS analysis_games ("
+    "game_id INTEGER PRIMARY KEY,"
+    "nodes INTEGER,"          // node budget per position
+    "plies INTEGER,"
+    "blunders INTEGER,"
+    "analyzed INTEGER);";     // unix time
+
+typedef struct {
+    char played[8];
+    char best[8];
+    int score;          // side to move's point of view
+    int loss;
+} PlyAnalysis;
+
+typedef struct {
+    int id;
+    char *moves;        // game text; freed by the worker
+    int plies;
+    int blunders;
+    double finished;    // now_seconds() when the worker handed it to the writer
+    PlyAnalysis ply[MAX_ANALYZED_PLIES];
+} GameJob;
+
+static int node_budget = 50000;
+static int blunder_cp = 200;
+static int game_limit = 0;
+static volatile sig_atomic_t interrupted = 0;
+
+// Reader -> workers
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_not_empty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t queue_not_full = PTHREAD_COND_INITIALIZER;
+static GameJob *queue[QUEUE_SIZE];
+static int queue_head = 0, queue_count = 0;
+static bool reader_done = false;
+
+// Workers -> writer
+static pthread_mutex_t done_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t done_ready = PTHREAD_COND_INITIALIZER;
+static GameJob **done_jobs = NULL;
+static int done_count = 0, done_capacity = 0;
+static int workers_running = 0;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void on_signal(int sig) {
+    (void)sig;
+    interrupted = 1;
+}
+
+// --- Reader ---
+
+static void queue_push(GameJob *job) {
+    pthread_mutex_lock(&queue_lock);
+    while (queue_count == QUEUE_SIZE) pthread_cond_wait(&queue_not_full, &queue_lock);
+    queue[(queue_head + queue_count++) % QUEUE_SIZE] = job;
+    pthread_cond_signal(&queue_not_empty);
+    pthread_mutex_unlock(&queue_lock);
+}
+
+static GameJob *queue_pop(void) {
+    pthread_mutex_lock(&queue_lock);
+    while (queue_count == 0 && !reader_done) pthread_cond_wait(&queue_not_empty, &queue_lock);
+    GameJob *job = NULL;
+    if (queue_count > 0) {
+        job = queue[queue_head];
+        queue_head = (queue_head + 1) % QUEUE_SIZE;
+        queue_count--;
+        pthread_cond_signal(&queue_not_full);
+    }
+    pthread_mutex_unlock(&queue_lock);
+    return job;
+}
+
+// Streams the games not analyzed yet, in id order, a page at a time. A
+// page is read in full and the statement reset before any game is queued:
+// waiting on a full queue must not hold the read lock the writer's commit needs.
+static void *reader_main(void *arg) {
+    sqlite3 *db = arg;
+    sqlite3_stmt *stmt;
+    const char *sql = "SELECT id, moves FROM games WHERE id > ?1 AND id NOT IN (SELECT game_id FROM analysis_games) "
+                      "ORDER BY id LIMIT ?2;";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Cannot read games: %s\n", sqlite3_errmsg(db));
+        stmt = NULL;
+    }
+    int last_id = 0, queued = 0;
+    bool more = stmt != NULL;
+    while (more && !interrupted) {
+        GameJob *page[READ_PAGE];
+        int rows = 0, rc;
+        sqlite3_bind_int(stmt, 1, last_id);
+        sqlite3_bind_int(stmt, 2, game_limit && game_limit - queued < READ_PAGE ? game_limit - queued : READ_PAGE);
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            last_id = sqlite3_column_int(stmt, 0);
+            const char *text = (const char *)sqlite3_column_text(stmt, 1);
+            GameJob *job = calloc(1, sizeof(GameJob));
+            if (!job || !(job->moves = strdup(text ? text : ""))) {
+                fprintf(stderr, "Warning: out of memory, stopping the reader.\n");
+                free(job);
+                more = false;
+                break;
+            }
+            job->id = last_id;
+            page[rows++] = job;
+        }
+        if (more && rc != SQLITE_DONE) {
+            fprintf(stderr, "Warning: reading games failed: %s\n", sqlite3_errmsg(db));
+            more = false;
+        }
+        sqlite3_reset(stmt);    // releases the read lock so the writer can commit
+        if (rows < READ_PAGE) more = false;
+        for (int i = 0; i < rows; i++) queue_push(page[i]);
+        queued += rows;
+        if (game_limit && queued >= game_limit) more = false;
+    }
+    sqlite3_finalize(stmt);
+
+    pthread_mutex_lock(&queue_lock);
+    reader_done = true;
+    pthread_cond_broadcast(&queue_not_empty);
+    pthread_mutex_unlock(&queue_lock);
+    return NULL;
+}
+
+// --- Workers ---
+
+// Game result tokens and move numbers ("12." / "12...") are not moves
+static bool skip_token(const char *tok) {
+    if (strcmp(tok, "1-0") == 0 || strcmp(tok, "0-1") == 0 || strcmp(tok, "1/2-1/2") == 0 || strcmp(tok, "*") == 0)
+        return true;
+    const char *p = tok;
+    while (isdigit((unsigned char)*p)) p++;
+    return p != tok && *p == '.' && p[strspn(p, ".")] == '\0';
+}
+
+static int clamp_score(int score) {
+    return score > LOSS_CLAMP ? LOSS_CLAMP : score < -LOSS_CLAMP ? -LOSS_CLAMP : score;
+}
+
+// Score of the side to move: a search, or the result when the game is over
+static int position_score(const Position *pos, const KeyHistory *history, Move *best, bool *has_best) {
+    *has_best = false;
+    GameStatus status = position_status(pos, history);
+    if (status == GAME_CHECKMATE) return -MATE_SCORE;
+    if (status != GAME_ONGOING) return 0;
+    // The pool shares the table, aged once per finished game in worker_main
+    SearchLimits limits = {.nodes = (uint64_t)node_budget, .keep_table_age = true};
+    SearchResult result;
+    if (!search(pos, history, &limits, &result)) return 0;
+    *best = result.best_move;
+    *has_best = true;
+    return result.score;
+}
+
+static void analyze_game(GameJob *job) {
+    Position pos;
+    position_from_fen(&pos, START_FEN);
+    KeyHistory history;
+    keys_clear(&history);
+
+    Move best;
+    bool has_best;
+    int score = position_score(&pos, &history, &best, &has_best);
+    char *save;    // the workers tokenize concurrently
+    for (char *tok = strtok_r(job->moves, " \t\r\n", &save); tok && job->plies < MAX_ANALYZED_PLIES;
+         tok = strtok_r(NULL, " \t\r\n", &save)) {
+        // "1.e4" carries its move number
+        char *dot = strrchr(tok, '.');
+        if (dot && dot[1] && isdigit((unsigned char)tok[0])) tok = dot + 1;
+        if (skip_token(tok)) continue;
+        Move m;
+        if (!move_parse(&pos, tok, &m)) {
+            fprintf(stderr, "Warning: game %d: cannot read move '%s', analyzing up to it.\n", job->id, tok);
+            break;
+        }
+
+        PlyAnalysis *a = &job->ply[job->plies++];
+        move_to_san(&pos, m, a->played);
+        if (has_best) move_to_san(&pos, best, a->best);
+        a->score = score;
+
+        uint64_t key = pos.key;
+        Undo undo;
+        make_move(&pos, m, &undo);
+        keys_push(&history, key, pos.halfmove);
+
+        // What the move gave away: the best score here against the score it left
+        score = position_score(&pos, &history, &best, &has_best);
+        a->loss = clamp_score(a->score) + clamp_score(score);
+        if (a->loss < 0) a->loss = 0;
+        if (a->loss >= blunder_cp) job->blunders++;
+    }
+    free(job->moves);
+    job->moves = NULL;
+}
+
+static void *worker_main(void *arg) {
+    (void)arg;
+    GameJob *job;
+    while ((job = queue_pop()) != NULL) {
+        if (interrupted) {
+            free(job->moves);
+            free(job);
+            continue;
+        }
+        analyze_game(job);
+        job->finished = now_seconds();
+        pthread_mutex_lock(&done_lock);
+        if (done_count == done_capacity) {
+            int capacity = done_capacity ? done_capacity * 2 : 64;
+            GameJob **grown = realloc(done_jobs, (size_t)capacity * sizeof(GameJob *));
+            if (grown) {
+                done_jobs = grown;
+                done_capacity = capacity;
+            }
+        }
+        if (done_count < done_capacity) done_jobs[done_count++] = job;
+        else free(job);     // out of memory: the game stays unanalyzed for the next run
+        tt_new_search();
+        pthread_cond_signal(&done_ready);
+        pthread_mutex_unlock(&done_lock);
+    }
+    pthread_mutex_lock(&done_lock);
+    workers_running--;
+    pthread_cond_signal(&done_ready);
+    pthread_mutex_unlock(&done_lock);
+    return NULL;
+}
+
+// --- Writer ---
+
+// One transaction per batch: the analysis rows of each game and its
+// analysis_games entry, which is the checkpoint, commit together
+static bool write_batch(sqlite3 *db, GameJob **jobs, int count, sqlite3_stmt *insert_ply, sqlite3_stmt *insert_game) {
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", NULL, NULL, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Warning: cannot start a transaction: %s\n", sqlite3_errmsg(db));
+        return false;
+    }
+    bool ok = true;
+    for (int g = 0; g < count && ok; g++) {
+        const GameJob *job = jobs[g];
+        for (int i = 0; i < job->plies && ok; i++) {
+            const PlyAnalysis *a = &job->ply[i];
+            int white_score = (i % 2 == 0) ? a->score : -a->score;   // every game starts with White to move
+            sqlite3_bind_int(insert_ply, 1, job->id);
+            sqlite3_bind_int(insert_ply, 2, i);
+            sqlite3_bind_text(insert_ply, 3, a->played, -1, SQLITE_STATIC);
+            sqlite3_bind_int(insert_ply, 4, score_is_mate(white_score) ? 0 : white_score);
+            sqlite3_bind_int(insert_ply, 5, score_mate_moves(white_score));
+            if (a->best[0]) sqlite3_bind_text(insert_ply, 6, a->best, -1, SQLITE_STATIC);
+            else sqlite3_bind_null(insert_ply, 6);
+            sqlite3_bind_int(insert_ply, 7, a->loss);
+            sqlite3_bind_int(insert_ply, 8, a->loss >= blunder_cp);
+            ok = sqlite3_step(insert_ply) == SQLITE_DONE;
+            sqlite3_reset(insert_ply);
+        }
+        sqlite3_bind_int(insert_game, 1, job->id);
+        sqlite3_bind_int(insert_game, 2, node_budget);
+        sqlite3_bind_int(insert_game, 3, job->plies);
+        sqlite3_bind_int(insert_game, 4, job->blunders);
+        sqlite3_bind_int64(insert_game, 5, (sqlite3_int64)time(NULL));
+        ok = ok && sqlite3_step(insert_game) == SQLITE_DONE;
+        sqlite3_reset(insert_game);
+    }
+    if (ok && sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL) == SQLITE_OK) return true;
+    fprintf(stderr, "Warning: storing the analysis failed: %s\n", sqlite3_errmsg(db));
+    sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+    return false;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "options:\n"
+        "  --db <file>      game history database (default saves/vortexmate.db)\n"
+        "  --nodes N        node budget per position (default 50000)\n"
+        "  --threads N      analysis threads (default: one per core)\n"
+        "  --batch N        games per write transaction (default 16)\n"
+        "  --blunder <cp>   flag moves losing at least this much (default 200)\n"
+        "  --limit N        analyze at most N games this run\n"
+        "  --hash <MB>      transposition table shared by the threads (default 64)\n"
+        "  --nnue <file>    evaluate with this network\n"
+        "Games already in analysis_games are skipped, so an interrupted run picks up where it stopped.\n",
+        prog);
+}
+
+int main(int argc, char **argv) {
+    const char *db_path = "saves/vortexmate.db", *nnue_path = NULL;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN), batch = 16;
+    size_t hash_mb = 64;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--db") == 0 && i + 1 < argc) db_path = argv[++i];
+        else if (strcmp(argv[i], "--nodes") == 0 && i + 1 < argc) node_budget = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) batch = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--blunder") == 0 && i + 1 < argc) blunder_cp = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--limit") == 0 && i + 1 < argc) game_limit = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--hash") == 0 && i + 1 < argc) hash_mb = (size_t)atol(argv[++i]);
+        else if (strcmp(argv[i], "--nnue") == 0 && i + 1 < argc) nnue_path = argv[++i];
+        else { usage(argv[0]); return 2; }
+    }
+    if (node_budget < 1 || threads < 1 || batch < 1 || blunder_cp < 1 || game_limit < 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    engine_init();
+    tt_resize(hash_mb);
+    search_set_threads(1);    // parallelism comes from the pool
+    if (nnue_path && !nnue_load(nnue_path)) {
+        fprintf(stderr, "Cannot load network %s\n", nnue_path);
+        return 1;
+    }
+
+    // Separate connections for the reader and the writer
+    sqlite3 *write_db = NULL, *read_db = NULL;
+    if (sqlite3_open_v2(db_path, &write_db, SQLITE_OPEN_READWRITE, NULL) != SQLITE_OK ||
+        sqlite3_open_v2(db_path, &read_db, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Cannot open %s: %s\n", db_path, sqlite3_errmsg(write_db ? write_db : read_db));
+        sqlite3_close(write_db);
+        sqlite3_close(read_db);
+        return 1;
+    }
+    sqlite3_busy_timeout(write_db, 10000);
+    sqlite3_busy_timeout(read_db, 10000);
+    char *err = NULL;
+    if (sqlite3_exec(write_db, schema_sql, NULL, NULL, &err) != SQLITE_OK) {
+        fprintf(stderr, "Cannot create the analysis tables: %s\n", err);
+        sqlite3_free(err);
+        return 1;
+    }
+    sqlite3_stmt *insert_ply = NULL, *insert_game = NULL, *count;
+    if (sqlite3_prepare_v2(write_db, "INSERT OR REPLACE INTO analysis VALUES (?, ?, ?, ?, ?, ?, ?, ?);", -1,
+                           &insert_ply, NULL) != SQLITE_OK ||
+        sqlite3_prepare_v2(write_db, "INSERT OR REPLACE INTO analysis_games VALUES (?, ?, ?, ?, ?);", -1,
+                           &insert_game, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Cannot prepare the analysis inserts: %s\n", sqlite3_errmsg(write_db));
+        sqlite3_finalize(insert_ply);
+        sqlite3_close(read_db);
+        sqlite3_close(write_db);
+        return 1;
+    }
+    int pending = 0, already = 0;
+    if (sqlite3_prepare_v2(write_db, "SELECT (SELECT COUNT(*) FROM games), (SELECT COUNT(*) FROM analysis_games);",
+                           -1, &count, NULL) == SQLITE_OK && sqlite3_step(count) == SQLITE_ROW) {
+        already = sqlite3_column_int(count, 1);
+        pending = sqlite3_column_int(count, 0) - already;
+    }
+    sqlite3_finalize(count);
+    if (game_limit && pending > game_limit) pending = game_limit;
+    printf("%s: %d games to analyze (%d done before), %d nodes per position, %d threads\n", db_path, pending, already,
+           node_budget, threads);
+    fflush(stdout);
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    // The pool first: with no worker to drain it the reader would wait on a full queue forever
+    double start = now_seconds();
+    pthread_t *pool = malloc((size_t)threads * sizeof(pthread_t));
+    int started = 0;
+    pthread_mutex_lock(&done_lock);
+    for (; pool && started < threads; started++) {
+        if (pthread_create(&pool[started], NULL, worker_main, NULL) != 0) break;
+        workers_running++;
+    }
+    pthread_mutex_unlock(&done_lock);
+    if (started > 0 && started < threads)
+        fprintf(stderr, "Warning: only %d of %d analysis threads started.\n", started, threads);
+    pthread_t reader;
+    bool reader_started = started > 0 && pthread_create(&reader, NULL, reader_main, read_db) == 0;
+    if (!reader_started) {
+        fprintf(stderr, started ? "Cannot start the reader thread\n" : "Cannot start any analysis threads\n");
+        pthread_mutex_lock(&queue_lock);
+        reader_done = true;
+        pthread_cond_broadcast(&queue_not_empty);
+        pthread_mutex_unlock(&queue_lock);
+        for (int i = 0; i < started; i++) pthread_join(pool[i], NULL);
+        free(pool);
+        sqlite3_finalize(insert_ply);
+        sqlite3_finalize(insert_game);
+        sqlite3_close(read_db);
+        sqlite3_close(write_db);
+        return 1;
+    }
+
+    // The writer: this thread. Commits a batch once it is full, the workers
+    // have finished, or the oldest waiting game was finished a couple of
+    // seconds ago. A batch that fails to commit is rolled back and kept for
+    // the next try.
+    GameJob **unsaved = NULL;
+    int unsaved_count = 0, unsaved_capacity = 0, failures = 0;
+    int written = 0, positions = 0, blunders = 0;
+    double last_report = start;
+    for (;;) {
+        pthread_mutex_lock(&done_lock);
+        for (;;) {
+            // Unsaved games were finished before any still in done_jobs
+            GameJob *oldest = unsaved_count ? unsaved[0] : done_count ? done_jobs[0] : NULL;
+            if (unsaved_count + done_count >= batch || workers_running == 0 ||
+                (oldest && now_seconds() - oldest->finished >= 2.0))
+                break;
+            struct timespec until;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_sec += 1;
+            pthread_cond_timedwait(&done_ready, &done_lock, &until);
+        }
+        if (unsaved_count + done_count > unsaved_capacity) {
+            int capacity = unsaved_count + done_count + 64;
+            GameJob **grown = realloc(unsaved, (size_t)capacity * sizeof(GameJob *));
+            if (grown) {
+                unsaved = grown;
+                unsaved_capacity = capacity;
+            }
+        }
+        if (unsaved_count + done_count <= unsaved_capacity) {
+            memcpy(unsaved + unsaved_count, done_jobs, (size_t)done_count * sizeof(GameJob *));
+            unsaved_count += done_count;
+            done_count = 0;
+        }
+        bool finished = workers_running == 0 && done_count == 0;
+        pthread_mutex_unlock(&done_lock);
+
+        if (unsaved_count > 0) {
+            if (write_batch(write_db, unsaved, unsaved_count, insert_ply, insert_game)) {
+                written += unsaved_count;
+                for (int i = 0; i < unsaved_count; i++) {
+                    positions += unsaved[i]->plies;
+                    blunders += unsaved[i]->blunders;
+                    free(unsaved[i]);
+                }
+                unsaved_count = 0;
+                failures = 0;
+            } else if (finished && ++failures >= MAX_WRITE_ATTEMPTS) {
+                fprintf(stderr, "Warning: %d analyzed games could not be stored; run again to redo them.\n", unsaved_count);
+                for (int i = 0; i < unsaved_count; i++) free(unsaved[i]);
+                unsaved_count = 0;
+            } else {
+                sleep(1);
+            }
+        }
+        double now = now_seconds();
+        if (now - last_report >= 5.0 || (finished && unsaved_count == 0 && written > 0)) {
+            double minutes = (now - start) / 60.0;
+            printf("%d/%d games, %d positions, %d blunders, %.1f games/min\n", written, pending, positions, blunders,
+                   minutes > 0 ? written / minutes : 0.0);
+            fflush(stdout);
+            last_report = now;
+        }
+        if (finished && unsaved_count == 0) break;
+    }
+    free(unsaved);
+
+    pthread_join(reader, NULL);
+    for (int i = 0; i < started; i++) pthread_join(pool[i], NULL);
+    free(pool);
+    free(done_jobs);
+    sqlite3_finalize(insert_ply);
+    sqlite3_finalize(insert_game);
+    sqlite3_close(read_db);
+    sqlite3_close(write_db);
+    tt_free();
+    nnue_unload();
+
+    if (interrupted) printf("Interrupted: %d games stored; run again to continue.\n", written);
+    return 0;
+}
@@ -0,0 +1,163 @@
+// vortex-bench: fixed-depth searches over a set of positions, reporting
+// nodes and speed. Switching search techniques off one at a time shows the
+// node reduction each one brings. Headless; links only the engine sources.
+#include "search.h"
+#include "engine.h"
+#include "tt.h"
+#include "nnue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *bench_fens[] = {
+    START_FEN,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "2r3k1/pp3ppp/4p3/3pP3/3P4/P4N2/1P3PPP/2R3K1 w - - 0 25",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+    "r1b2rk1/2q1b1pp/p2ppn2/1p6/3QP3/1BN1B3/PPP3PP/R4RK1 w - - 0 1",
+    "8/8/1p1k4/p1p5/P1P1K3/1P6/8/8 w - - 0 1",
+};
+
+static const struct {
+    const char *flag;
+    unsigned bit;
+} switches[] = {
+    {"--no-pvs",        SEARCH_NO_PVS},
+    {"--no-aspiration", SEARCH_NO_ASPIRATION},
+    {"--no-null",       SEARCH_NO_NULL_MOVE},
+    {"--no-lmr",        SEARCH_NO_LMR},
+    {"--no-check-ext",  SEARCH_NO_CHECK_EXT},
+};
+#define SWITCH_COUNT (int)(sizeof(switches) / sizeof(switches[0]))
+
+// --multipv: print every line of the last iteration
+static SearchLine last_lines[MAX_MULTIPV];
+static int last_line_count = 0;
+
+static void keep_lines(const SearchLine *lines, int count, void *ctx) {
+    (void)ctx;
+    memcpy(last_lines, lines, (size_t)count * sizeof(SearchLine));
+    last_line_count = count;
+}
+
+static void print_lines(void) {
+    for (int i = 0; i < last_line_count; i++) {
+        const SearchLine *l = &last_lines[i];
+        printf("    %2d  %6d ", l->multipv, l->score);
+        for (int j = 0; j < l->pv_length; j++) {
+            char uci[6];
+            move_to_uci(l->pv[j], uci);
+            printf(" %s", uci);
+        }
+        printf("\n");
+    }
+}
+
+static double percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+static void print_stats(const SearchStats *s) {
+    printf("    seldepth %d, qnodes %.1f%%, tt hits %.1f%% (cutoffs %.1f%%), first-move cutoffs %.1f%%\n",
+           s->seldepth, percent(s->qnodes, s->nodes), percent(s->tt_hits, s->tt_probes),
+           percent(s->tt_cutoffs, s->tt_probes), percent(s->first_move_fail_highs, s->fail_highs));
+    printf("    null moves %llu (%.1f%% cut), lmr re-searches %llu, pvs re-searches %llu\n",
+           (unsigned long long)s->null_tries, percent(s->null_cutoffs, s->null_tries),
+           (unsigned long long)s->lmr_researches, (unsigned long long)s->pvs_researches);
+    printf("    ms per iteration:");
+    for (int d = 0; d < s->depth; d++) printf(" %d", s->iteration_ms[d]);
+    printf("\n");
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options] [depth]\n"
+        "options:\n"
+        "  --threads N      search threads (default 1; node counts vary run to run above 1)\n"
+        "  --hash <MB>      transposition table size (default %d)\n"
+        "  --fen <fen>      search this position instead of the built-in set\n"
+        "  --nnue <file>    evaluate with this network instead of the classical evaluation\n"
+        "  --multipv N      search the N best lines and print them (up to %d)\n"
+        "  --stats          print search statistics for each position\n",
+        prog, TT_DEFAULT_MB, MAX_MULTIPV);
+    for (int i = 0; i < SWITCH_COUNT; i++) fprintf(stderr, "  %s\n", switches[i].flag);
+    fprintf(stderr, "depth defaults to 8\n");
+}
+
+int main(int argc, char **argv) {
+    int depth = 8, threads = 1, multipv = 1;
+    size_t hash_mb = TT_DEFAULT_MB;
+    const char *fen = NULL, *nnue_path = NULL;
+    unsigned disable = 0;
+    bool stats = false;
+
+    for (int i = 1; i < argc; i++) {
+        bool matched = false;
+        for (int j = 0; j < SWITCH_COUNT; j++) {
+            if (strcmp(argv[i], switches[j].flag) == 0) {
+                disable |= switches[j].bit;
+                matched = true;
+            }
+        }
+        if (matched) continue;
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--hash") == 0 && i + 1 < argc) hash_mb = (size_t)atol(argv[++i]);
+        else if (strcmp(argv[i], "--fen") == 0 && i + 1 < argc) fen = argv[++i];
+        else if (strcmp(argv[i], "--nnue") == 0 && i + 1 < argc) nnue_path = argv[++i];
+        else if (strcmp(argv[i], "--multipv") == 0 && i + 1 < argc) multipv = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--stats") == 0) stats = true;
+        else if (argv[i][0] != '-' && atoi(argv[i]) > 0) depth = atoi(argv[i]);
+        else { usage(argv[0]); return 2; }
+    }
+
+    engine_init();
+    tt_resize(hash_mb);
+    search_set_threads(threads);
+    if (nnue_path && !nnue_load(nnue_path)) {
+        fprintf(stderr, "Cannot load network %s\n", nnue_path);
+        return 1;
+    }
+
+    const char **fens = fen ? &fen : bench_fens;
+    int count = fen ? 1 : (int)(sizeof(bench_fens) / sizeof(bench_fens[0]));
+    uint64_t total_nodes = 0;
+    double start = now_seconds();
+    for (int i = 0; i < count; i++) {
+        Position pos;
+        if (!position_from_fen(&pos, fens[i])) {
+            fprintf(stderr, "Invalid FEN: %s\n", fens[i]);
+            return 2;
+        }
+        tt_clear();
+        srand(1);   // root ties are broken at random; keep runs repeatable
+        SearchLimits limits = {.depth = depth, .disable = disable, .multipv = multipv,
+                               .report = multipv > 1 ? keep_lines : NULL};
+        last_line_count = 0;
+        SearchResult result;
+        char uci[6] = "none";
+        if (search(&pos, NULL, &limits, &result)) move_to_uci(result.best_move, uci);
+        else memset(&result, 0, sizeof(result));
+        printf("%2d  %-6s %6d  %12llu nodes  %6d ms\n", i + 1, uci, result.score,
+               (unsigned long long)result.nodes, result.time_ms);
+        print_lines();
+        if (stats) print_stats(&result.stats);
+        total_nodes += result.nodes;
+    }
+    double elapsed = now_seconds() - start;
+    printf("\n%llu nodes in %.3f s (%.0f nps)\n", (unsigned long long)total_nodes, elapsed,
+           elapsed > 0 ? (double)total_nodes / elapsed : 0.0);
+    tt_free();
+    nnue_unload();
+    return 0;
+}
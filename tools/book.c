@@ -0,0 +1,176 @@
+// vortex-book: builds an opening book from the games table of the game
+// history database. Each position of the first plies of every game credits
+// the move played with 2 points for a win, 1 for a draw or resignation and
+// 0 for a loss; the totals become the book weights.
+#include "position.h"
+#include "movegen.h"
+#include "notation.h"
+#include "book.h"
+#include "engine.h"
+#include "db.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+typedef struct {
+    uint64_t key;
+    uint16_t move;
+    uint32_t points;
+    uint32_t games;
+} BookStat;
+
+static BookStat *stats = NULL;
+static size_t stat_count = 0, stat_capacity = 0;
+
+static bool stat_add(uint64_t key, uint16_t move, uint32_t points) {
+    if (stat_count == stat_capacity) {
+        size_t capacity = stat_capacity ? stat_capacity * 2 : 4096;
+        BookStat *grown = realloc(stats, capacity * sizeof(BookStat));
+        if (!grown) return false;
+        stats = grown;
+        stat_capacity = capacity;
+    }
+    stats[stat_count++] = (BookStat){key, move, points, 1};
+    return true;
+}
+
+static int stat_compare(const void *a, const void *b) {
+    const BookStat *x = a, *y = b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return (int)x->move - (int)y->move;
+}
+
+// Game result tokens and move numbers ("12." / "12...") are not moves
+static bool skip_token(const char *tok) {
+    if (strcmp(tok, "1-0") == 0 || strcmp(tok, "0-1") == 0 || strcmp(tok, "1/2-1/2") == 0 || strcmp(tok, "*") == 0)
+        return true;
+    const char *p = tok;
+    while (isdigit((unsigned char)*p)) p++;
+    return p != tok && *p == '.' && p[strspn(p, ".")] == '\0';
+}
+
+// Replays one game's move text for up to max_ply plies; returns plies added
+static int add_game(const char *text, DbResult result, int max_ply, int id) {
+    Position pos;
+    position_from_fen(&pos, START_FEN);
+    char buf[1024];
+    strncpy(buf, text, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+
+    int ply = 0;
+    for (char *tok = strtok(buf, " \t\r\n"); tok && ply < max_ply; tok = strtok(NULL, " \t\r\n")) {
+        // "1.e4" carries its move number
+        char *dot = strrchr(tok, '.');
+        if (dot && dot[1] && isdigit((unsigned char)tok[0])) tok = dot + 1;
+        if (skip_token(tok)) continue;
+
+        Move m;
+        if (!move_parse(&pos, tok, &m)) {
+            fprintf(stderr, "Warning: game %d: cannot read move '%s', skipping the rest.\n", id, tok);
+            break;
+        }
+        uint32_t points = 1;
+        if (result == DB_WHITE_WIN) points = pos.side > 0 ? 2 : 0;
+        else if (result == DB_BLACK_WIN) points = pos.side < 0 ? 2 : 0;
+        if (!stat_add(pos.key, book_encode_move(m), points)) {
+            fprintf(stderr, "Warning: out of memory, book truncated.\n");
+            return -1;
+        }
+        Undo undo;
+        make_move(&pos, m, &undo);
+        ply++;
+    }
+    return ply;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options] [out.bin]\n"
+        "options:\n"
+        "  --db <file>      game history database (default saves/vortexmate.db)\n"
+        "  --depth <plies>  plies of each game to record (default %d)\n"
+        "  --min-games N    drop moves played in fewer than N games (default 1)\n"
+        "output defaults to assets/book.bin\n",
+        prog, BOOK_DEFAULT_DEPTH);
+}
+
+int main(int argc, char **argv) {
+    const char *db_path = "saves/vortexmate.db";
+    const char *out_path = NULL;
+    int depth = BOOK_DEFAULT_DEPTH, min_games = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--db") == 0 && i + 1 < argc) db_path = argv[++i];
+        else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) depth = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--min-games") == 0 && i + 1 < argc) min_games = atoi(argv[++i]);
+        else if (!out_path && argv[i][0] != '-') out_path = argv[i];
+        else { usage(argv[0]); return 2; }
+    }
+    if (!out_path) out_path = "assets/book.bin";
+    if (depth < 1) { usage(argv[0]); return 2; }
+
+    engine_init();
+
+    sqlite3 *db;
+    if (sqlite3_open_v2(db_path, &db, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Cannot open %s: %s\n", db_path, sqlite3_errmsg(db));
+        sqlite3_close(db);
+        return 1;
+    }
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT id, moves, result FROM games;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Cannot read games from %s: %s\n", db_path, sqlite3_errmsg(db));
+        sqlite3_close(db);
+        return 1;
+    }
+    int games = 0;
+    long plies = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char *text = (const char *)sqlite3_column_text(stmt, 1);
+        if (!text) continue;
+        int added = add_game(text, (DbResult)sqlite3_column_int(stmt, 2), depth, sqlite3_column_int(stmt, 0));
+        if (added < 0) break;
+        plies += added;
+        games++;
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    // Merge repeats of the same move from the same position
+    qsort(stats, stat_count, sizeof(BookStat), stat_compare);
+    size_t merged = 0;
+    uint32_t max_points = 0;
+    for (size_t i = 0; i < stat_count; i++) {
+        if (merged > 0 && stats[merged - 1].key == stats[i].key && stats[merged - 1].move == stats[i].move) {
+            stats[merged - 1].points += stats[i].points;
+            stats[merged - 1].games++;
+        } else {
+            stats[merged++] = stats[i];
+        }
+        if (stats[merged - 1].points > max_points) max_points = stats[merged - 1].points;
+    }
+
+    FILE *f = fopen(out_path, "wb");
+    if (!f) {
+        fprintf(stderr, "Cannot write %s\n", out_path);
+        return 1;
+    }
+    // Weights are 16 bits: scale down only when the busiest move would overflow
+    size_t written = 0;
+    for (size_t i = 0; i < merged; i++) {
+        if (stats[i].games < (uint32_t)min_games || stats[i].points == 0) continue;
+        uint32_t weight = max_points > 65535 ? (uint32_t)((uint64_t)stats[i].points * 65535 / max_points) : stats[i].points;
+        if (weight == 0) weight = 1;
+        BookEntry e = {stats[i].key, stats[i].move, (uint16_t)weight, 0};
+        uint8_t record[BOOK_ENTRY_SIZE];
+        book_entry_write(&e, record);
+        fwrite(record, 1, sizeof(record), f);
+        written++;
+    }
+    fclose(f);
+    free(stats);
+
+    printf("%d games, %ld plies -> %zu book entries in %s\n", games, plies, written, out_path);
+    return written ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+// vortex-egtb: builds (or loads) the endgame tables and prints their
+// statistics, to check against the published figures for each ending.
+// Headless; links only the engine sources.
+#include "egtb.h"
+#include "engine.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options] [fen...]\n"
+        "options:\n"
+        "  --dir <path>   table cache directory (default assets; tables missing there are built and saved)\n"
+        "  --no-cache     build in memory only\n"
+        "Prints table statistics, then the table result for each FEN given.\n",
+        prog);
+}
+
+int main(int argc, char **argv) {
+    const char *dir = "assets";
+    int first_fen = argc;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) dir = argv[++i];
+        else if (strcmp(argv[i], "--no-cache") == 0) dir = NULL;
+        else if (argv[i][0] == '-') { usage(argv[0]); return 2; }
+        else { first_fen = i; break; }
+    }
+
+    engine_init();
+    double start = now_seconds();
+    egtb_init(dir);
+    egtb_wait();
+    printf("Tables ready in %.2f s\n\n", now_seconds() - start);
+
+    printf("%-5s  %-13s %12s %12s %9s\n", "table", "side to move", "positions", "mates", "longest");
+    bool all_ready = true;
+    for (int i = 0; i < EGTB_TABLES; i++) {
+        EgtbStats st;
+        egtb_stats((EgtbTable)i, &st);
+        if (!st.ready) {
+            printf("%-5s  not available\n", st.name);
+            all_ready = false;
+            continue;
+        }
+        for (int stm = 0; stm < 2; stm++) {
+            printf("%-5s  %-13s %12zu %12zu %5d plies\n", stm ? "" : st.name, stm ? "lone king" : "strong side",
+                   st.positions[stm], st.wins[stm], st.longest[stm]);
+        }
+    }
+
+    for (int i = first_fen; i < argc; i++) {
+        Position pos;
+        if (!position_from_fen(&pos, argv[i])) {
+            fprintf(stderr, "Invalid FEN: %s\n", argv[i]);
+            continue;
+        }
+        int plies = 0;
+        EgtbResult r = egtb_probe(&pos, &plies);
+        static const char *names[] = {"not in the tables", "win", "draw", "loss"};
+        printf("\n%s\n  %s", argv[i], names[r]);
+        if (r == EGTB_WIN || r == EGTB_LOSS) printf(" in %d plies", plies);
+        printf(" for the side to move\n");
+    }
+    egtb_free();
+    return all_ready ? 0 : 1;
+}
@@ -0,0 +1,244 @@
+// vortex-nnue: writes starter networks in the engine's NNUE format and checks
+// a network file: incrementally updated accumulators against ones computed
+// from scratch, every SIMD kernel against the scalar one, and the speed of
+// each. Headless; links only the engine sources.
+#include "nnue.h"
+#include "movegen.h"
+#include "engine.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_GAME_LENGTH 200
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state;
+
+static int rng_range(int lo, int hi) {
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return lo + (int)((rng_state >> 33) % (uint64_t)(hi - lo + 1));
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+// Sections are written in host order, which the format requires to be little-endian
+static bool write_section(FILE *f, const void *data, size_t size) {
+    return fwrite(data, 1, size, f) == size;
+}
+
+// The PSQT path carries the classical material and piece-square values (the
+// middlegame/endgame average, as there is no phase input), so even an
+// untrained network plays sensibly. With random, the hidden layers get small
+// pseudo-random weights too, so every layer and kernel has real work to do.
+static bool write_network(const char *path, bool random) {
+    int16_t *ft_bias = calloc(NNUE_L1, sizeof(int16_t));
+    int16_t *ft_weights = calloc((size_t)NNUE_FEATURES * NNUE_L1, sizeof(int16_t));
+    int32_t *ft_psqt = calloc(NNUE_FEATURES, sizeof(int32_t));
+    int32_t l1_bias[NNUE_L2] = {0}, l2_bias[NNUE_L3] = {0}, out_bias = 0;
+    static int8_t l1_weights[NNUE_L2 * 2 * NNUE_L1], l2_weights[NNUE_L3 * NNUE_L2], out_weights[NNUE_L3];
+    if (!ft_bias || !ft_weights || !ft_psqt) {
+        fprintf(stderr, "Out of memory\n");
+        return false;
+    }
+
+    for (int king_sq = 0; king_sq < 64; king_sq++) {
+        for (int piece = -W_QUEEN; piece <= W_QUEEN; piece++) {
+            if (piece == EMPTY) continue;
+            int type = piece > 0 ? piece : -piece;
+            for (int sq = 0; sq < 64; sq++) {
+                Score s = psqt[COLOR_IDX(piece)][type][sq];
+                ft_psqt[nnue_feature(1, king_sq, piece, sq)] = (SCORE_MG(s) + SCORE_EG(s)) / 2 * NNUE_OUTPUT_SCALE;
+            }
+        }
+    }
+    if (random) {
+        for (int i = 0; i < NNUE_L1; i++) ft_bias[i] = (int16_t)rng_range(0, 64);
+        for (size_t i = 0; i < (size_t)NNUE_FEATURES * NNUE_L1; i++) ft_weights[i] = (int16_t)rng_range(-8, 8);
+        for (int i = 0; i < NNUE_L2 * 2 * NNUE_L1; i++) l1_weights[i] = (int8_t)rng_range(-16, 16);
+        for (int i = 0; i < NNUE_L3 * NNUE_L2; i++) l2_weights[i] = (int8_t)rng_range(-32, 32);
+        for (int i = 0; i < NNUE_L3; i++) out_weights[i] = (int8_t)rng_range(-8, 8);
+        for (int i = 0; i < NNUE_L2; i++) l1_bias[i] = rng_range(-1024, 1024);
+        for (int i = 0; i < NNUE_L3; i++) l2_bias[i] = rng_range(-1024, 1024);
+    }
+
+    uint8_t header[NNUE_HEADER_SIZE] = {0};
+    memcpy(header, NNUE_MAGIC, 8);
+    put_le32(header + 8, NNUE_FEATURES);
+    put_le32(header + 12, NNUE_L1);
+    put_le32(header + 16, NNUE_L2);
+    put_le32(header + 20, NNUE_L3);
+
+    bool ok = false;
+    FILE *f = fopen(path, "wb");
+    if (f) {
+        ok = write_section(f, header, sizeof(header)) &&
+             write_section(f, ft_bias, NNUE_L1 * sizeof(int16_t)) &&
+             write_section(f, ft_weights, (size_t)NNUE_FEATURES * NNUE_L1 * sizeof(int16_t)) &&
+             write_section(f, ft_psqt, NNUE_FEATURES * sizeof(int32_t)) &&
+             write_section(f, l1_bias, sizeof(l1_bias)) && write_section(f, l1_weights, sizeof(l1_weights)) &&
+             write_section(f, l2_bias, sizeof(l2_bias)) && write_section(f, l2_weights, sizeof(l2_weights)) &&
+             write_section(f, &out_bias, sizeof(out_bias)) && write_section(f, out_weights, sizeof(out_weights));
+        ok = (fclose(f) == 0) && ok;
+    }
+    if (!ok) fprintf(stderr, "Cannot write %s\n", path);
+    free(ft_bias);
+    free(ft_weights);
+    free(ft_psqt);
+    return ok;
+}
+
+static const char *kernel_names[] = {"avx2", "sse4.1", "scalar"};
+#define KERNEL_NAMES (int)(sizeof(kernel_names) / sizeof(kernel_names[0]))
+
+// Evaluation of pos from scratch with the named kernel
+static int fresh_eval(const Position *pos, const char *name) {
+    Position copy = *pos;    // not the tracked position, so nothing incremental is used
+    nnue_set_kernel(name);
+    return nnue_evaluate(&copy);
+}
+
+// Random games on a tracked position, stepping back now and then so the
+// accumulator stack is also exercised after unmake. Returns mismatches.
+static long check_games(int games, const char *best, long *evals) {
+    long mismatches = 0;
+    for (int g = 0; g < games; g++) {
+        Position pos;
+        position_from_fen(&pos, START_FEN);
+        nnue_attach(&pos);
+        Move played[MAX_GAME_LENGTH];
+        Undo undos[MAX_GAME_LENGTH];
+        int ply = 0;
+        for (int step = 0; step < MAX_GAME_LENGTH && ply < MAX_GAME_LENGTH; step++) {
+            if (ply > 0 && rng_range(0, 7) == 0) {
+                for (int back = rng_range(1, ply < 4 ? ply : 4); back > 0; back--) {
+                    ply--;
+                    unmake_move(&pos, played[ply], &undos[ply]);
+                }
+            } else {
+                Move moves[MAX_MOVES];
+                int count = generate_moves(&pos, moves);
+                if (count == 0) break;
+                played[ply] = moves[rng_range(0, count - 1)];
+                make_move(&pos, played[ply], &undos[ply]);
+                ply++;
+            }
+
+            nnue_set_kernel(best);
+            int incremental = nnue_evaluate(&pos);
+            int reference = fresh_eval(&pos, "scalar");
+            (*evals)++;
+            bool bad = incremental != reference;
+            for (int k = 0; k < KERNEL_NAMES; k++) {
+                if (nnue_set_kernel(kernel_names[k]) && fresh_eval(&pos, kernel_names[k]) != reference) bad = true;
+            }
+            if (bad && mismatches++ < 5)
+                fprintf(stderr, "Mismatch in game %d at ply %d: incremental %d, scalar %d\n", g + 1, ply, incremental, reference);
+        }
+        nnue_detach();
+    }
+    nnue_set_kernel(best);
+    return mismatches;
+}
+
+// Evaluations per second along random games, incrementally updated
+static void time_kernel(const char *name, int games) {
+    if (!nnue_set_kernel(name)) {
+        printf("  %-7s not supported by this CPU\n", name);
+        return;
+    }
+    rng_state = 1;
+    long evals = 0;
+    volatile int sink = 0;
+    double start = now_seconds();
+    for (int g = 0; g < games; g++) {
+        Position pos;
+        position_from_fen(&pos, START_FEN);
+        nnue_attach(&pos);
+        Undo undos[MAX_GAME_LENGTH];
+        Move played[MAX_GAME_LENGTH];
+        int ply = 0;
+        for (; ply < MAX_GAME_LENGTH; ply++) {
+            Move moves[MAX_MOVES];
+            int count = generate_moves(&pos, moves);
+            if (count == 0) break;
+            // Every move from here, as a search would see them
+            for (int i = 0; i < count; i++) {
+                Undo undo;
+                make_move(&pos, moves[i], &undo);
+                sink += nnue_evaluate(&pos);
+                evals++;
+                unmake_move(&pos, moves[i], &undo);
+            }
+            played[ply] = moves[rng_range(0, count - 1)];
+            make_move(&pos, played[ply], &undos[ply]);
+            if (ply >= 48) break;   // stay inside the accumulator stack
+        }
+        nnue_detach();
+    }
+    double elapsed = now_seconds() - start;
+    printf("  %-7s %9.0f evaluations/s\n", name, elapsed > 0 ? (double)evals / elapsed : 0.0);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "options:\n"
+        "  --write <file>    write a starter network: the classical piece-square values, zero hidden layers\n"
+        "  --seed N          with --write, fill the hidden layers with pseudo-random weights from seed N\n"
+        "  --verify <file>   check a network over random games and time each kernel\n"
+        "  --games N         games for --verify (default 100)\n"
+        "The network the game loads is %s.\n",
+        prog, NNUE_DEFAULT_PATH);
+}
+
+int main(int argc, char **argv) {
+    const char *write_path = NULL, *verify_path = NULL;
+    bool random = false;
+    int games = 100;
+    rng_state = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--write") == 0 && i + 1 < argc) write_path = argv[++i];
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) random = true, rng_state = (uint64_t)atoll(argv[++i]);
+        else if (strcmp(argv[i], "--verify") == 0 && i + 1 < argc) verify_path = argv[++i];
+        else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) games = atoi(argv[++i]);
+        else { usage(argv[0]); return 2; }
+    }
+    if ((!write_path && !verify_path) || games < 1) { usage(argv[0]); return 2; }
+
+    engine_init();
+    if (write_path) {
+        if (!write_network(write_path, random)) return 1;
+        printf("Wrote %s\n", write_path);
+    }
+    if (!verify_path) return 0;
+
+    if (!nnue_load(verify_path)) {
+        fprintf(stderr, "Cannot load %s\n", verify_path);
+        return 1;
+    }
+    const char *best = nnue_kernel();
+    printf("%s: kernel %s\n", verify_path, best);
+
+    Position start;
+    position_from_fen(&start, START_FEN);
+    printf("Start position: %d\n", nnue_evaluate(&start));
+
+    long evals = 0;
+    rng_state = 12345;
+    long mismatches = check_games(games, best, &evals);
+    printf("%ld positions checked, %ld mismatches\n", evals, mismatches);
+
+    printf("Speed:\n");
+    for (int k = 0; k < KERNEL_NAMES; k++) time_kernel(kernel_names[k], games < 20 ? games : 20);
+    nnue_unload();
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,203 @@
+// vortex-perft: move generator node counts, divide output and throughput.
+// Headless; links only the engine sources.
+#include "position.h"
+#include "movegen.h"
+#include "engine.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// --- Perft transposition table: always-replace, keyed by Zobrist key and depth ---
+typedef struct {
+    uint64_t key;
+    uint64_t nodes;
+    int depth;
+} PerftEntry;
+
+static PerftEntry *perft_table = NULL;
+static size_t perft_mask = 0;
+static bool bulk_counting = false;
+
+static void perft_table_init(size_t mb) {
+    size_t count = 1;
+    while (count * 2 * sizeof(PerftEntry) <= mb * 1024 * 1024) count *= 2;
+    perft_table = calloc(count, sizeof(PerftEntry));
+    if (!perft_table) {
+        fprintf(stderr, "Warning: could not allocate %zu MB perft table, running without it.\n", mb);
+        return;
+    }
+    perft_mask = count - 1;
+}
+
+// Leaves are played like every other move unless bulk counting is on
+static uint64_t perft(Position *pos, int depth) {
+    if (depth == 0) return 1;
+    Move moves[MAX_MOVES];
+    int count = generate_moves(pos, moves);
+    if (depth == 1 && bulk_counting) return (uint64_t)count;
+
+    uint64_t key = 0;
+    if (perft_table && depth > 1) {
+        key = pos->key ^ (uint64_t)depth;
+        PerftEntry *e = &perft_table[key & perft_mask];
+        if (e->key == key && e->depth == depth) return e->nodes;
+    }
+
+    uint64_t nodes = 0;
+    Undo undo;
+    for (int i = 0; i < count; i++) {
+        make_move(pos, moves[i], &undo);
+        nodes += perft(pos, depth - 1);
+        unmake_move(pos, moves[i], &undo);
+    }
+
+    if (perft_table && depth > 1) {
+        PerftEntry *e = &perft_table[key & perft_mask];
+        e->key = key; e->depth = depth; e->nodes = nodes;
+    }
+    return nodes;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Per-root-move counts, then the total
+static uint64_t divide(Position *pos, int depth) {
+    Move moves[MAX_MOVES];
+    int count = generate_moves(pos, moves);
+    uint64_t total = 0;
+    Undo undo;
+    char uci[6];
+    for (int i = 0; i < count; i++) {
+        make_move(pos, moves[i], &undo);
+        uint64_t nodes = perft(pos, depth - 1);
+        unmake_move(pos, moves[i], &undo);
+        move_to_uci(moves[i], uci);
+        printf("%-6s %llu\n", uci, (unsigned long long)nodes);
+        total += nodes;
+    }
+    return total;
+}
+
+// --- Built-in suite: standard positions and rule edge cases with known counts ---
+typedef struct {
+    const char *name;
+    const char *fen;
+    int depth;
+    uint64_t nodes;
+} PerftCase;
+
+static const PerftCase suite[] = {
+    {"startpos",              START_FEN, 5, 4865609ULL},
+    {"kiwipete",              "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603ULL},
+    {"rook endgame",          "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6, 11030083ULL},
+    {"promotions and pins",   "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333ULL},
+    {"castling after check",  "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487ULL},
+    {"middlegame",            "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594ULL},
+    {"ep discovered check",   "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 6, 1134888ULL},
+    {"ep into check",         "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467ULL},
+    {"ep capture pinned",     "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", 6, 1015133ULL},
+    {"short castling",        "5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072ULL},
+    {"long castling",         "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711ULL},
+    {"castling rights lost",  "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, 1274206ULL},
+    {"castling prevented",    "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476ULL},
+    {"promote out of check",  "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001ULL},
+    {"discovered check",      "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, 1004658ULL},
+    {"promote to give check", "4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342ULL},
+    {"underpromote to check", "8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683ULL},
+    {"self stalemate",        "K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217ULL},
+    {"stalemate and mate",    "8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, 567584ULL},
+    {"double check",          "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527ULL},
+};
+
+// Records the parser must reject: move generation assumes none of these
+static const struct { const char *name; const char *fen; } illegal[] = {
+    {"pawn on rank 8",        "P3k3/8/8/8/8/8/8/4K3 w - - 0 1"},
+    {"pawn on rank 1",        "4k3/8/8/8/8/8/8/p3K3 w - - 0 1"},
+    {"no white king",         "4k3/8/8/8/8/8/8/8 w - - 0 1"},
+    {"no black king",         "8/8/8/8/8/8/8/4K3 w - - 0 1"},
+    {"two white kings",       "4k3/8/8/8/8/8/8/3KK3 w - - 0 1"},
+    {"side not to move in check", "4k3/8/8/8/8/8/8/4R1K1 w - - 0 1"},
+    {"kings touching",        "8/8/8/8/8/8/8/3Kk3 w - - 0 1"},
+};
+
+static int run_suite(int max_depth) {
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(illegal) / sizeof(illegal[0]); i++) {
+        Position pos;
+        bool ok = !position_from_fen(&pos, illegal[i].fen);
+        printf("%-4s rejects %s\n", ok ? "ok" : "FAIL", illegal[i].name);
+        failures += !ok;
+    }
+    uint64_t total_nodes = 0;
+    double start = now_seconds();
+    for (size_t i = 0; i < sizeof(suite) / sizeof(suite[0]); i++) {
+        const PerftCase *c = &suite[i];
+        if (c->depth > max_depth) continue;
+        Position pos;
+        position_from_fen(&pos, c->fen);
+        uint64_t nodes = perft(&pos, c->depth);
+        bool ok = (nodes == c->nodes);
+        printf("%-4s %-22s depth %d  %12llu", ok ? "ok" : "FAIL", c->name, c->depth, (unsigned long long)nodes);
+        if (!ok) printf("  (expected %llu)", (unsigned long long)c->nodes);
+        printf("\n");
+        failures += !ok;
+        total_nodes += nodes;
+    }
+    double elapsed = now_seconds() - start;
+    printf("\n%llu nodes in %.3f s (%.0f nps), %d failure(s)\n",
+           (unsigned long long)total_nodes, elapsed, elapsed > 0 ? (double)total_nodes / elapsed : 0.0, failures);
+    return failures ? 1 : 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options] <fen|startpos> <depth>\n"
+        "       %s [options] --suite\n"
+        "options:\n"
+        "  --bulk         count legal moves at the last ply instead of playing them (faster,\n"
+        "                 but make/unmake and key updates go unchecked there)\n"
+        "  --hash <MB>    perft transposition table size (default 0, disabled)\n"
+        "  --max-depth N  with --suite, skip cases deeper than N\n",
+        prog, prog);
+}
+
+int main(int argc, char **argv) {
+    const char *fen = NULL;
+    int depth = 0, max_depth = 99;
+    bool run_builtin = false;
+    size_t hash_mb = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--suite") == 0) run_builtin = true;
+        else if (strcmp(argv[i], "--bulk") == 0) bulk_counting = true;
+        else if (strcmp(argv[i], "--hash") == 0 && i + 1 < argc) hash_mb = (size_t)atol(argv[++i]);
+        else if (strcmp(argv[i], "--max-depth") == 0 && i + 1 < argc) max_depth = atoi(argv[++i]);
+        else if (!fen) fen = argv[i];
+        else if (!depth) depth = atoi(argv[i]);
+        else { usage(argv[0]); return 2; }
+    }
+    if (!run_builtin && (!fen || depth < 1)) { usage(argv[0]); return 2; }
+
+    engine_init();
+    if (hash_mb > 0) perft_table_init(hash_mb);
+
+    if (run_builtin) return run_suite(max_depth);
+
+    Position pos;
+    if (!position_from_fen(&pos, strcmp(fen, "startpos") == 0 ? START_FEN : fen)) {
+        fprintf(stderr, "Invalid FEN: %s\n", fen);
+        return 2;
+    }
+    double start = now_seconds();
+    uint64_t nodes = divide(&pos, depth);
+    double elapsed = now_seconds() - start;
+    printf("\nNodes: %llu\nTime: %.3f s\nNPS: %.0f\n", (unsigned long long)nodes, elapsed,
+           elapsed > 0 ? (double)nodes / elapsed : 0.0);
+    free(perft_table);
+    return 0;
+}
@@ -0,0 +1,511 @@
+// vortex-selfplay: plays two engine configurations against each other, many
+// games at once on all cores, and reports the Elo difference with its error
+// bars and a sequential probability ratio test (SPRT), so a change can be
+// accepted or rejected on evidence. Headless; links the engine sources and
+// db.c (for --db).
+#include "search.h"
+#include "notation.h"
+#include "engine.h"
+#include "nnue.h"
+#include "tt.h"
+#include "db.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Longer games are adjudicated as draws
+#define MAX_SELFPLAY_PLIES 400
+// Kept back from the clock, as a GUI would
+#define MOVE_OVERHEAD_MS 10
+#define DEFAULT_MOVES_TO_GO 30
+#define MAX_OPENING_TEXT 256
+
+typedef struct {
+    char name[32];
+    SearchLimits limits;    // depth, nodes, movetime and disabled techniques
+    int base_ms, inc_ms;    // game clock; 0 base means per-move limits only
+    TTable table;           // this engine's own: what one side learns must not help the other
+} EngineConfig;
+
+typedef struct {
+    Position start;
+    KeyHistory history;
+    char moves[MAX_OPENING_TEXT];   // SAN from the start position, "" for FEN openings
+    bool from_startpos;
+} Opening;
+
+static EngineConfig engines[2];
+static Opening *openings = NULL;
+static int opening_count = 0;
+
+// Tournament state, under the lock
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static int next_game = 0, total_games = 1000, finished = 0;
+static int wins = 0, draws = 0, losses = 0;    // for engine A
+static bool sprt_stop = false, sprt_enabled = false;
+static double elo0 = 0.0, elo1 = 5.0, sprt_alpha = 0.05, sprt_beta = 0.05;
+static bool use_db = false;
+static bool warned_fen_db = false;
+static int too_long_for_db = 0;    // games whose moves did not fit DbGame.moves, not stored
+static double start_s;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec * 1e-6;
+}
+
+static uint64_t rng_state = 1;
+
+static int rng_below(int n) {
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (int)((rng_state >> 33) % (uint64_t)n);
+}
+
+// --- Engine configurations: "nodes=20000,no-lmr", "tc=10+0.1", ... ---
+
+static const struct {
+    const char *flag;
+    unsigned bit;
+} switches[] = {
+    {"no-pvs",        SEARCH_NO_PVS},
+    {"no-aspiration", SEARCH_NO_ASPIRATION},
+    {"no-null",       SEARCH_NO_NULL_MOVE},
+    {"no-lmr",        SEARCH_NO_LMR},
+    {"no-check-ext",  SEARCH_NO_CHECK_EXT},
+};
+#define SWITCH_COUNT (int)(sizeof(switches) / sizeof(switches[0]))
+
+static bool parse_engine(const char *spec, EngineConfig *e) {
+    memset(e, 0, sizeof(*e));
+    snprintf(e->name, sizeof(e->name), "%s", spec);
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", spec);
+    for (char *tok = strtok(buf, ", "); tok; tok = strtok(NULL, ", ")) {
+        double base, inc = 0.0;
+        bool matched = false;
+        for (int i = 0; i < SWITCH_COUNT; i++) {
+            if (strcmp(tok, switches[i].flag) == 0) {
+                e->limits.disable |= switches[i].bit;
+                matched = true;
+            }
+        }
+        if (matched) continue;
+        if (strncmp(tok, "depth=", 6) == 0) e->limits.depth = atoi(tok + 6);
+        else if (strncmp(tok, "nodes=", 6) == 0) e->limits.nodes = (uint64_t)atoll(tok + 6);
+        else if (strncmp(tok, "movetime=", 9) == 0) e->limits.movetime_ms = atoi(tok + 9);
+        else if (strncmp(tok, "tc=", 3) == 0 && sscanf(tok + 3, "%lf+%lf", &base, &inc) >= 1) {
+            e->base_ms = (int)(base * 1000.0);
+            e->inc_ms = (int)(inc * 1000.0);
+        } else {
+            fprintf(stderr, "Unknown engine setting '%s'\n", tok);
+            return false;
+        }
+    }
+    if (!e->limits.depth && !e->limits.nodes && !e->limits.movetime_ms && !e->base_ms) {
+        fprintf(stderr, "Engine '%s' has no depth, nodes, movetime or tc limit\n", spec);
+        return false;
+    }
+    return true;
+}
+
+// --- Openings ---
+
+static bool add_opening(const Opening *o) {
+    if (opening_count % 64 == 0) {
+        Opening *grown = realloc(openings, (size_t)(opening_count + 64) * sizeof(Opening));
+        if (!grown) return false;
+        openings = grown;
+    }
+    openings[opening_count++] = *o;
+    return true;
+}
+
+// Plays the moves of text (UCI or SAN, move numbers allowed) from the start position
+static bool opening_from_moves(const char *text, Opening *o) {
+    position_from_fen(&o->start, START_FEN);
+    keys_clear(&o->history);
+    o->from_startpos = true;
+    o->moves[0] = '\0';
+    char buf[MAX_OPENING_TEXT];
+    if (snprintf(buf, sizeof(buf), "%s", text) >= (int)sizeof(buf)) return false;   // moves would not fit o->moves
+    size_t len = 0;
+    for (char *tok = strtok(buf, " \t\r\n"); tok; tok = strtok(NULL, " \t\r\n")) {
+        char *dot = strrchr(tok, '.');
+        if (dot) tok = dot + 1;
+        if (!*tok) continue;
+        Move m;
+        if (!move_parse(&o->start, tok, &m)) return false;
+        char san[8];
+        move_to_san(&o->start, m, san);
+        len += (size_t)snprintf(o->moves + len, sizeof(o->moves) - len, "%s%s", len ? " " : "", san);
+        if (len >= sizeof(o->moves)) return false;
+        uint64_t key = o->start.key;
+        Undo undo;
+        make_move(&o->start, m, &undo);
+        keys_push(&o->history, key, o->start.halfmove);
+    }
+    return has_legal_moves(&o->start);
+}
+
+// One opening per line: a FEN or EPD record, or moves from the start position
+static bool load_openings(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+    char line[512];
+    int number = 0;
+    while (fgets(line, sizeof(line), f)) {
+        number++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (!line[strspn(line, " \t")] || line[0] == '#') continue;
+        Opening o;
+        bool ok;
+        if (strchr(line, '/')) {
+            // EPD has no move counters and may carry operations after them: keep four fields
+            char fields[4][80];
+            char fen[sizeof(fields) + 8];
+            ok = sscanf(line, "%79s %79s %79s %79s", fields[0], fields[1], fields[2], fields[3]) == 4;
+            if (ok) {
+                snprintf(fen, sizeof(fen), "%s %s %s %s 0 1", fields[0], fields[1], fields[2], fields[3]);
+                ok = position_from_fen(&o.start, fen) && has_legal_moves(&o.start);
+            }
+            keys_clear(&o.history);
+            o.moves[0] = '\0';
+            o.from_startpos = false;
+        } else {
+            ok = opening_from_moves(line, &o);
+        }
+        if (!ok) {
+            fprintf(stderr, "Warning: %s:%d is not a playable opening, skipping it.\n", path, number);
+            continue;
+        }
+        if (!add_opening(&o)) break;
+    }
+    fclose(f);
+    return opening_count > 0;
+}
+
+// Without a file: the start position plus a few random plies, different each pair
+static bool random_openings(int count, int plies) {
+    for (int i = 0; i < count; i++) {
+        Opening o;
+        position_from_fen(&o.start, START_FEN);
+        keys_clear(&o.history);
+        o.from_startpos = true;
+        o.moves[0] = '\0';
+        size_t len = 0;
+        for (int p = 0; p < plies; p++) {
+            Move moves[MAX_MOVES];
+            int n = generate_moves(&o.start, moves);
+            if (n == 0) break;
+            Move m = moves[rng_below(n)];
+            char san[8];
+            move_to_san(&o.start, m, san);
+            len += (size_t)snprintf(o.moves + len, sizeof(o.moves) - len, "%s%s", len ? " " : "", san);
+            uint64_t key = o.start.key;
+            Undo undo;
+            make_move(&o.start, m, &undo);
+            keys_push(&o.history, key, o.start.halfmove);
+        }
+        if (!has_legal_moves(&o.start)) {
+            i--;
+            continue;
+        }
+        if (!add_opening(&o)) return false;
+    }
+    return true;
+}
+
+// --- Games ---
+
+// Appends "12. Nf3" / "Nc6" style text. Once a move does not fit the record
+// it is marked truncated and takes no more, so it never skips a move.
+static void record_move(DbGame *record, size_t *len, bool *truncated, int ply, const char *san) {
+    if (*truncated) return;
+    char token[24];
+    if (ply % 2 == 0) snprintf(token, sizeof(token), "%s%d. %s", *len ? " " : "", ply / 2 + 1, san);
+    else snprintf(token, sizeof(token), " %s", san);
+    size_t n = strlen(token);
+    if (*len + n >= sizeof(record->moves)) {
+        *truncated = true;
+        return;
+    }
+    memcpy(record->moves + *len, token, n + 1);
+    *len += n;
+}
+
+// Plays one game; returns 1, 0 or -1 for White. *truncated tells whether
+// the record lacks moves that did not fit.
+static int play_game(const Opening *o, const EngineConfig *white, const EngineConfig *black, DbGame *record,
+                     bool *truncated) {
+    Position pos = o->start;
+    KeyHistory history = o->history;
+    int clock[2] = {white->base_ms, black->base_ms};
+    size_t len = 0;
+    int ply = 0;
+    record->moves[0] = '\0';
+    *truncated = false;
+
+    // Replay the opening into the record so stored games start from the initial position
+    if (o->from_startpos && o->moves[0]) {
+        char buf[MAX_OPENING_TEXT];
+        snprintf(buf, sizeof(buf), "%s", o->moves);
+        char *save;    // game threads tokenize concurrently
+        for (char *tok = strtok_r(buf, " ", &save); tok; tok = strtok_r(NULL, " ", &save))
+            record_move(record, &len, truncated, ply++, tok);
+    }
+
+    for (;;) {
+        GameStatus status = position_status(&pos, &history);
+        if (status == GAME_CHECKMATE) return -pos.side;
+        if (status != GAME_ONGOING || ply >= MAX_SELFPLAY_PLIES) return 0;
+
+        int us = COLOR_IDX(pos.side);
+        const EngineConfig *e = us == 0 ? white : black;
+        SearchLimits limits = e->limits;
+        limits.keep_table_age = true;
+        if (e->base_ms) {
+            int budget = clock[us] / DEFAULT_MOVES_TO_GO + e->inc_ms * 3 / 4;
+            if (budget > clock[us] - MOVE_OVERHEAD_MS) budget = clock[us] - MOVE_OVERHEAD_MS;
+            if (budget < 1) budget = 1;
+            if (!limits.movetime_ms || budget < limits.movetime_ms) limits.movetime_ms = budget;
+        }
+
+        double started = now_ms();
+        SearchResult result;
+        if (!search(&pos, &history, &limits, &result)) return 0;   // unreachable: status said ongoing
+        if (e->base_ms) {
+            clock[us] -= (int)(now_ms() - started);
+            if (clock[us] < 0) return -pos.side;    // lost on time
+            clock[us] += e->inc_ms;
+        }
+
+        char san[8];
+        move_to_san(&pos, result.best_move, san);
+        record_move(record, &len, truncated, ply++, san);
+        uint64_t key = pos.key;
+        Undo undo;
+        make_move(&pos, result.best_move, &undo);
+        keys_push(&history, key, pos.halfmove);
+    }
+}
+
+// --- Statistics ---
+
+static double elo_from_score(double score) {
+    if (score <= 0.0) score = 1e-6;
+    if (score >= 1.0) score = 1.0 - 1e-6;
+    return -400.0 * log10(1.0 / score - 1.0);
+}
+
+static double score_from_elo(double elo) {
+    return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+// Elo of A over B with the 95% interval, from the per-game score variance
+static void elo_estimate(double *elo, double *margin) {
+    int n = wins + draws + losses;
+    double score = (wins + 0.5 * draws) / n;
+    double var = (wins * (1.0 - score) * (1.0 - score) + draws * (0.5 - score) * (0.5 - score) +
+                  losses * score * score) / n;
+    double spread = 1.96 * sqrt(var / n);
+    *elo = elo_from_score(score);
+    *margin = (elo_from_score(score + spread) - elo_from_score(score - spread)) / 2.0;
+}
+
+// Log-likelihood ratio of elo1 against elo0, in the normal approximation of
+// the trinomial model: each game's score has the observed variance.
+static double sprt_llr(void) {
+    int n = wins + draws + losses;
+    double score = (wins + 0.5 * draws) / n;
+    double var = (wins * (1.0 - score) * (1.0 - score) + draws * (0.5 - score) * (0.5 - score) +
+                  losses * score * score) / n;
+    if (var <= 0.0) return 0.0;
+    double s0 = score_from_elo(elo0), s1 = score_from_elo(elo1);
+    return n * (s1 - s0) * (2.0 * score - s0 - s1) / (2.0 * var);
+}
+
+static void print_status(bool final) {
+    int n = wins + draws + losses;
+    if (n == 0) return;
+    double elo, margin;
+    elo_estimate(&elo, &margin);
+    double minutes = (now_ms() / 1000.0 - start_s) / 60.0;
+    printf("%s%5d games  +%d =%d -%d  Elo %+.1f +/- %.1f  %.0f games/min", final ? "\n" : "", n, wins, draws, losses,
+           elo, margin, minutes > 0 ? n / minutes : 0.0);
+    if (sprt_enabled) {
+        printf("  LLR %.2f [%.2f, %.2f]", sprt_llr(), log(sprt_beta / (1.0 - sprt_alpha)),
+               log((1.0 - sprt_beta) / sprt_alpha));
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+static void *worker_main(void *arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&lock);
+        int game = (sprt_stop || next_game >= total_games) ? -1 : next_game++;
+        pthread_mutex_unlock(&lock);
+        if (game < 0) break;
+
+        // Each opening is played twice, A taking White in the first game
+        const Opening *o = &openings[(game / 2) % opening_count];
+        bool a_white = (game % 2 == 0);
+        DbGame record;
+        memset(&record, 0, sizeof(record));
+        bool truncated;
+        int white_result = play_game(o, &engines[a_white ? 0 : 1], &engines[a_white ? 1 : 0], &record, &truncated);
+        int a_result = a_white ? white_result : -white_result;
+
+        pthread_mutex_lock(&lock);
+        if (a_result > 0) wins++;
+        else if (a_result < 0) losses++;
+        else draws++;
+        finished++;
+        // Each engine's games share its table: age it once per finished game, not once per search
+        ttable_new_search(&engines[0].table);
+        ttable_new_search(&engines[1].table);
+        if (use_db) {
+            if (truncated) {
+                too_long_for_db++;
+            } else if (o->from_startpos) {
+                record.date = time(NULL);
+                snprintf(record.white, sizeof(record.white), "%s", engines[a_white ? 0 : 1].name);
+                snprintf(record.black, sizeof(record.black), "%s", engines[a_white ? 1 : 0].name);
+                record.result = white_result > 0 ? DB_WHITE_WIN : white_result < 0 ? DB_BLACK_WIN : DB_DRAW;
+                db_add_game(&record);
+            } else if (!warned_fen_db) {
+                fprintf(stderr, "Warning: games from FEN openings are not stored, the games table replays from the start position.\n");
+                warned_fen_db = true;
+            }
+        }
+        if (sprt_enabled && !sprt_stop) {
+            double llr = sprt_llr();
+            if (llr >= log((1.0 - sprt_beta) / sprt_alpha) || llr <= log(sprt_beta / (1.0 - sprt_alpha)))
+                sprt_stop = true;
+        }
+        if (finished % 20 == 0 && finished < total_games) print_status(false);
+        pthread_mutex_unlock(&lock);
+    }
+    return NULL;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "options:\n"
+        "  -a <engine>          engine A (default \"nodes=20000\")\n"
+        "  -b <engine>          engine B (default \"nodes=20000\")\n"
+        "  --games N            games to play (default 1000), in pairs with colors swapped\n"
+        "  --concurrency N      games at once (default: one per core)\n"
+        "  --openings <file>    one FEN/EPD or move list (from the start position) per line\n"
+        "  --random-plies N     without --openings: random plies from the start position (default 6)\n"
+        "  --sprt <elo0> <elo1> stop as soon as the SPRT accepts either hypothesis (alpha = beta = 0.05)\n"
+        "  --hash <MB>          transposition table per engine, shared by its games (default 64)\n"
+        "  --nnue <file>        both engines evaluate with this network\n"
+        "  --db <file>          store the games in this game history database\n"
+        "  --seed N             random opening seed (default 1)\n"
+        "engine: comma-separated depth=N, nodes=N, movetime=MS, tc=SECONDS+INC, and\n"
+        "        no-pvs, no-aspiration, no-null, no-lmr, no-check-ext\n"
+        "Elo is A's gain over B.\n",
+        prog);
+}
+
+int main(int argc, char **argv) {
+    const char *spec[2] = {"nodes=20000", "nodes=20000"};
+    const char *openings_path = NULL, *db_path = NULL, *nnue_path = NULL;
+    int concurrency = (int)sysconf(_SC_NPROCESSORS_ONLN), random_plies = 6;
+    size_t hash_mb = 64;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) spec[0] = argv[++i];
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) spec[1] = argv[++i];
+        else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) total_games = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--concurrency") == 0 && i + 1 < argc) concurrency = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--openings") == 0 && i + 1 < argc) openings_path = argv[++i];
+        else if (strcmp(argv[i], "--random-plies") == 0 && i + 1 < argc) random_plies = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--sprt") == 0 && i + 2 < argc) {
+            sprt_enabled = true;
+            elo0 = atof(argv[++i]);
+            elo1 = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--hash") == 0 && i + 1 < argc) hash_mb = (size_t)atol(argv[++i]);
+        else if (strcmp(argv[i], "--nnue") == 0 && i + 1 < argc) nnue_path = argv[++i];
+        else if (strcmp(argv[i], "--db") == 0 && i + 1 < argc) db_path = argv[++i];
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) rng_state = (uint64_t)atoll(argv[++i]);
+        else { usage(argv[0]); return 2; }
+    }
+    if (total_games < 1 || concurrency < 1 || random_plies < 0 || (sprt_enabled && elo1 <= elo0)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    engine_init();
+    if (!parse_engine(spec[0], &engines[0]) || !parse_engine(spec[1], &engines[1])) return 2;
+    for (int i = 0; i < 2; i++) {
+        if (!ttable_resize(&engines[i].table, hash_mb)) return 1;
+        engines[i].limits.table = &engines[i].table;
+    }
+    search_set_threads(1);    // parallelism comes from the games
+    if (nnue_path && !nnue_load(nnue_path)) {
+        fprintf(stderr, "Cannot load network %s\n", nnue_path);
+        return 1;
+    }
+    if (openings_path ? !load_openings(openings_path) : !random_openings((total_games + 1) / 2, random_plies)) {
+        fprintf(stderr, "No openings to play\n");
+        return 1;
+    }
+    if (db_path) {
+        if (!db_open(db_path)) return 1;
+        use_db = true;
+    }
+
+    printf("A: %s\nB: %s\n%d games, %d at a time, %d openings\n", engines[0].name, engines[1].name, total_games,
+           concurrency, opening_count);
+    if (sprt_enabled) printf("SPRT: elo0 %.1f, elo1 %.1f, alpha %.2f, beta %.2f\n", elo0, elo1, sprt_alpha, sprt_beta);
+    fflush(stdout);
+
+    start_s = now_ms() / 1000.0;
+    pthread_t *threads = malloc((size_t)concurrency * sizeof(pthread_t));
+    int started = 0;
+    for (; threads && started < concurrency; started++) {
+        if (pthread_create(&threads[started], NULL, worker_main, NULL) != 0) break;
+    }
+    if (started == 0) {
+        fprintf(stderr, "Could not start any game threads\n");
+        return 1;
+    }
+    for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    free(threads);
+
+    print_status(true);
+    if (too_long_for_db)
+        fprintf(stderr, "Warning: %d games were too long for the games table and were not stored.\n", too_long_for_db);
+    int status = 0;
+    if (sprt_enabled) {
+        double llr = sprt_llr();
+        if (llr >= log((1.0 - sprt_beta) / sprt_alpha)) printf("SPRT: H1 accepted, A is stronger by at least %.1f Elo\n", elo1);
+        else if (llr <= log(sprt_beta / (1.0 - sprt_alpha))) {
+            printf("SPRT: H0 accepted, A is not stronger by %.1f Elo\n", elo1);
+            status = 1;
+        } else {
+            printf("SPRT: inconclusive after %d games\n", finished);
+            status = 3;
+        }
+    }
+
+    if (use_db) db_close();
+    free(openings);
+    nnue_unload();
+    ttable_free(&engines[0].table);
+    ttable_free(&engines[1].table);
+    return status;
+}
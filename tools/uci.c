@@ -0,0 +1,288 @@
+// vortex-uci: the engine over the UCI protocol on stdin/stdout, for
+// tournament managers, benchmarks and servers without a display.
+// Headless; links only the engine sources.
+#include "search.h"
+#include "notation.h"
+#include "engine.h"
+#include "egtb.h"
+#include "nnue.h"
+#include "tt.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// Kept back from the clock for the GUI and the pipe
+#define MOVE_OVERHEAD_MS 50
+// Moves left to plan for when the GUI does not say
+#define DEFAULT_MOVES_TO_GO 30
+
+static Position root;
+static KeyHistory history;
+static int multipv = 1;
+
+// The search runs on its own thread so stop and ponderhit are read meanwhile
+static pthread_t search_thread;
+static bool searching = false;
+static pthread_mutex_t wait_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wait_cond = PTHREAD_COND_INITIALIZER;
+static volatile bool stop_flag = false;
+static volatile bool ponder_flag = false;
+static bool infinite = false;    // bestmove waits for stop even once the search is done
+static SearchLimits limits;
+
+static void send(const char *line) {
+    fputs(line, stdout);
+    fputc('\n', stdout);
+    fflush(stdout);
+}
+
+static void report(const SearchLine *lines, int count, void *ctx) {
+    (void)ctx;
+    SearchStats stats;
+    search_current_stats(&stats);
+    for (int i = 0; i < count; i++) {
+        const SearchLine *l = &lines[i];
+        char buf[1024];
+        int mate = score_mate_moves(l->score);
+        int len = snprintf(buf, sizeof(buf),
+                           "info depth %d seldepth %d multipv %d score %s %d nodes %llu time %d nps %llu pv",
+                           l->depth, stats.seldepth, l->multipv, mate ? "mate" : "cp", mate ? mate : l->score,
+                           (unsigned long long)l->nodes, l->time_ms,
+                           (unsigned long long)(l->time_ms > 0 ? l->nodes * 1000 / (uint64_t)l->time_ms : 0));
+        for (int j = 0; j < l->pv_length && len < (int)sizeof(buf) - 8; j++) {
+            char uci[6];
+            move_to_uci(l->pv[j], uci);
+            len += snprintf(buf + len, sizeof(buf) - (size_t)len, " %s", uci);
+        }
+        send(buf);
+    }
+}
+
+static void *search_main(void *arg) {
+    (void)arg;
+    SearchResult result;
+    bool found = search(&root, &history, &limits, &result);
+
+    // While pondering or analysing, the GUI expects bestmove only after stop or ponderhit
+    pthread_mutex_lock(&wait_lock);
+    while (!stop_flag && (infinite || ponder_flag)) pthread_cond_wait(&wait_cond, &wait_lock);
+    pthread_mutex_unlock(&wait_lock);
+
+    char buf[32] = "bestmove 0000";
+    if (found) {
+        char best[6], reply[6];
+        move_to_uci(result.best_move, best);
+        if (result.has_ponder) {
+            move_to_uci(result.ponder_move, reply);
+            snprintf(buf, sizeof(buf), "bestmove %s ponder %s", best, reply);
+        } else {
+            snprintf(buf, sizeof(buf), "bestmove %s", best);
+        }
+    }
+    send(buf);
+    return NULL;
+}
+
+static void wake_search(void) {
+    pthread_mutex_lock(&wait_lock);
+    pthread_cond_broadcast(&wait_cond);
+    pthread_mutex_unlock(&wait_lock);
+}
+
+// Ends the running search, if any; its bestmove is printed before this returns
+static void stop_search(void) {
+    if (!searching) return;
+    stop_flag = true;
+    wake_search();
+    pthread_join(search_thread, NULL);
+    searching = false;
+}
+
+// position [startpos | fen <fen>] [moves <m1> <m2> ...]
+static void cmd_position(char *args) {
+    char *moves = strstr(args, "moves");
+    if (moves) *moves = '\0';
+
+    Position pos;
+    if (strncmp(args, "startpos", 8) == 0) {
+        position_from_fen(&pos, START_FEN);
+    } else if (strncmp(args, "fen", 3) == 0) {
+        if (!position_from_fen(&pos, args + 3 + strspn(args + 3, " "))) {
+            send("info string invalid fen");
+            return;
+        }
+    } else {
+        send("info string expected startpos or fen");
+        return;
+    }
+
+    keys_clear(&history);
+    if (moves) {
+        for (char *tok = strtok(moves + 5, " \t\r\n"); tok; tok = strtok(NULL, " \t\r\n")) {
+            Move m;
+            if (!move_from_uci(&pos, tok, &m)) {
+                char buf[64];
+                snprintf(buf, sizeof(buf), "info string illegal move %.16s", tok);
+                send(buf);
+                break;
+            }
+            uint64_t key = pos.key;
+            Undo undo;
+            make_move(&pos, m, &undo);
+            keys_push(&history, key, pos.halfmove);
+        }
+    }
+    root = pos;
+}
+
+static long long next_number(void) {
+    char *tok = strtok(NULL, " \t\r\n");
+    return tok ? atoll(tok) : 0;
+}
+
+static void cmd_go(char *args) {
+    long long time_left[2] = {0, 0}, inc[2] = {0, 0};
+    int moves_to_go = 0;
+    SearchLimits l = {.stop = &stop_flag, .ponder = &ponder_flag, .multipv = multipv, .report = report};
+    bool ponder = false;
+    infinite = false;
+
+    for (char *tok = strtok(args, " \t\r\n"); tok; tok = strtok(NULL, " \t\r\n")) {
+        if (strcmp(tok, "depth") == 0) l.depth = (int)next_number();
+        else if (strcmp(tok, "movetime") == 0) l.movetime_ms = (int)next_number();
+        else if (strcmp(tok, "nodes") == 0) l.nodes = (uint64_t)next_number();
+        else if (strcmp(tok, "wtime") == 0) time_left[0] = next_number();
+        else if (strcmp(tok, "btime") == 0) time_left[1] = next_number();
+        else if (strcmp(tok, "winc") == 0) inc[0] = next_number();
+        else if (strcmp(tok, "binc") == 0) inc[1] = next_number();
+        else if (strcmp(tok, "movestogo") == 0) moves_to_go = (int)next_number();
+        else if (strcmp(tok, "infinite") == 0) infinite = true;
+        else if (strcmp(tok, "ponder") == 0) ponder = true;
+    }
+
+    // A share of the clock: what is left over the moves to go, plus most of the increment
+    int us = COLOR_IDX(root.side);
+    if (!l.movetime_ms && time_left[us] > 0 && !infinite) {
+        long long budget = time_left[us] / (moves_to_go > 0 ? moves_to_go : DEFAULT_MOVES_TO_GO) + inc[us] * 3 / 4;
+        if (budget > time_left[us] - MOVE_OVERHEAD_MS) budget = time_left[us] - MOVE_OVERHEAD_MS;
+        l.movetime_ms = budget > 1 ? (int)budget : 1;
+    }
+
+    limits = l;
+    stop_flag = false;
+    ponder_flag = ponder;
+    if (pthread_create(&search_thread, NULL, search_main, NULL) != 0) {
+        send("info string could not start the search thread");
+        send("bestmove 0000");
+        return;
+    }
+    searching = true;
+}
+
+// setoption name <name> value <value>
+static void cmd_setoption(char *args) {
+    char *name = strstr(args, "name");
+    char *value = strstr(args, "value");
+    if (!name) return;
+    name += 4;
+    name += strspn(name, " ");
+    if (value) {
+        char *end = value;
+        while (end > name && end[-1] == ' ') end--;
+        *end = '\0';
+        value += 5;
+        value += strspn(value, " ");
+        value[strcspn(value, "\r\n")] = '\0';
+    } else {
+        name[strcspn(name, "\r\n")] = '\0';
+    }
+
+    if (strcasecmp(name, "Hash") == 0 && value) {
+        int mb = atoi(value) > 0 ? atoi(value) : 1;
+        if (!tt_resize((size_t)mb)) send("info string could not allocate the hash table");
+    } else if (strcasecmp(name, "Threads") == 0 && value) {
+        search_set_threads(atoi(value));
+    } else if (strcasecmp(name, "MultiPV") == 0 && value) {
+        multipv = atoi(value) < 1 ? 1 : atoi(value) > MAX_MULTIPV ? MAX_MULTIPV : atoi(value);
+    } else if (strcasecmp(name, "EvalFile") == 0 && value) {
+        if (strcmp(value, "<empty>") == 0 || !*value) nnue_unload();
+        else if (!nnue_load(value)) send("info string network not loaded, using the classical evaluation");
+    } else if (strcasecmp(name, "EgtbPath") == 0 && value) {
+        // Tables missing from the directory are built again there, in the background
+        egtb_free();
+        egtb_init(strcmp(value, "<empty>") == 0 || !*value ? NULL : value);
+    } else if (strcasecmp(name, "Ponder") == 0) {
+        // Nothing to set up: the GUI decides when to send go ponder
+    } else {
+        char buf[128];
+        snprintf(buf, sizeof(buf), "info string unknown option %.64s", name);
+        send(buf);
+    }
+}
+
+static void cmd_uci(void) {
+    char buf[128];
+    send("id name VortexMate");
+    send("id author the VortexMate developers");
+    snprintf(buf, sizeof(buf), "option name Hash type spin default %d min 1 max 65536", TT_DEFAULT_MB);
+    send(buf);
+    snprintf(buf, sizeof(buf), "option name Threads type spin default 1 min 1 max %d", MAX_SEARCH_THREADS);
+    send(buf);
+    snprintf(buf, sizeof(buf), "option name MultiPV type spin default 1 min 1 max %d", MAX_MULTIPV);
+    send(buf);
+    send("option name Ponder type check default false");
+    send("option name EvalFile type string default " NNUE_DEFAULT_PATH);
+    send("option name EgtbPath type string default <empty>");
+    send("uciok");
+}
+
+int main(void) {
+    static char line[65536];   // "position startpos moves ..." grows with the game
+
+    engine_init();
+    tt_resize(TT_DEFAULT_MB);
+    nnue_load(NNUE_DEFAULT_PATH);
+    egtb_init(NULL);    // in memory: the working directory is the GUI's, not ours; EgtbPath sets a cache
+    position_from_fen(&root, START_FEN);
+    keys_clear(&history);
+
+    while (fgets(line, sizeof(line), stdin)) {
+        char *cmd = line + strspn(line, " \t\r\n");
+        if (!*cmd) continue;
+        char *rest = cmd + strcspn(cmd, " \t\r\n");
+        if (*rest) *rest++ = '\0';
+        rest += strspn(rest, " \t");
+
+        if (strcmp(cmd, "uci") == 0) {
+            cmd_uci();
+        } else if (strcmp(cmd, "isready") == 0) {
+            send("readyok");
+        } else if (strcmp(cmd, "ucinewgame") == 0) {
+            stop_search();
+            tt_clear();
+        } else if (strcmp(cmd, "position") == 0) {
+            stop_search();
+            cmd_position(rest);
+        } else if (strcmp(cmd, "go") == 0) {
+            stop_search();
+            cmd_go(rest);
+        } else if (strcmp(cmd, "stop") == 0) {
+            stop_search();
+        } else if (strcmp(cmd, "ponderhit") == 0) {
+            ponder_flag = false;   // the search goes on the clock, which starts now
+            wake_search();
+        } else if (strcmp(cmd, "setoption") == 0) {
+            stop_search();
+            cmd_setoption(rest);
+        } else if (strcmp(cmd, "quit") == 0) {
+            break;
+        }
+    }
+    stop_search();
+    tt_free();
+    nnue_unload();
+    egtb_free();
+    return 0;
+}